@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 CONFIG += c++11
 
@@ -11,27 +11,51 @@ CONFIG += c++11
 SOURCES += \
     main.cpp \
     mainwindow/mainwindow.cpp \
+    taskone/automatacache.cpp \
+    taskone/automatonmodel.cpp \
+    taskone/derivative.cpp \
     taskone/dfa.cpp \
+    taskone/dfaimage.cpp \
+    taskone/keywordhash.cpp \
+    taskone/lexer.cpp \
+    taskone/lexercache.cpp \
+    taskone/literaltrie.cpp \
     taskone/nfa.cpp \
+    taskone/regexsimplifier.cpp \
+    taskone/searcher.cpp \
     taskone/taskonewidget.cpp \
+    taskone/tokenqueue.cpp \
     taskone/utils/utils.cpp \
     tasktwo/analysistable.cpp \
     tasktwo/intermediatecode.cpp \
     tasktwo/lr.cpp \
     tasktwo/syntaxtree.cpp \
-    tasktwo/tasktwowidget.cpp
+    tasktwo/tasktwowidget.cpp \
+    tasktwo/tokenstream.cpp
 
 HEADERS += \
     mainwindow/mainwindow.h \
+    taskone/automatacache.h \
+    taskone/automatonmodel.h \
+    taskone/derivative.h \
     taskone/dfa.h \
+    taskone/dfaimage.h \
+    taskone/keywordhash.h \
+    taskone/lexer.h \
+    taskone/lexercache.h \
+    taskone/literaltrie.h \
     taskone/nfa.h \
+    taskone/regexsimplifier.h \
+    taskone/searcher.h \
     taskone/taskonewidget.h \
+    taskone/tokenqueue.h \
     taskone/utils/utils.h \
     tasktwo/analysistable.h \
     tasktwo/intermediatecode.h \
     tasktwo/lr.h \
     tasktwo/syntaxtree.h \
-    tasktwo/tasktwowidget.h
+    tasktwo/tasktwowidget.h \
+    tasktwo/tokenstream.h
 
 FORMS += \
     mainwindow/mainwindow.ui \
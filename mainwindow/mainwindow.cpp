@@ -31,6 +31,9 @@ MainWindow::MainWindow(QWidget *parent)
     ui->tabWidget->setTabText(1, "项目任务二");
     ui->tabWidget->setCurrentIndex(0);
 
+    // 项目任务二的流式语法分析直接使用项目任务一的词法分析器
+    ui->task_2_tab->lexer = &ui->task_1_tab->lexer;
+
 }
 
 MainWindow::~MainWindow()
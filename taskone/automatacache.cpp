@@ -0,0 +1,130 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    automatacache.cpp
+*  @brief   自动机磁盘缓存实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "automatacache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDateTime>
+
+// 缓存文件格式：魔数、版本号、后缀正则表达式、是否保留状态来源、DFA、最小化 DFA
+static const quint32 CACHE_MAGIC = 0x44464143;     // "DFAC"
+static const quint32 CACHE_VERSION = 2;
+
+QString AutomataCache::cacheDir;
+int AutomataCache::maxEntries = 512;
+
+/*!
+    @name   directory
+    @brief  实际使用的缓存目录
+    @param
+    @return cacheDir 不为空时为 cacheDir，否则为 QStandardPaths::CacheLocation 下的 automata_cache
+    @attention  不随工作目录变化；系统缓存目录依赖应用名称，须在 QApplication 构造之后调用
+*/
+QString AutomataCache::directory() {
+    if (!cacheDir.isEmpty()) return cacheDir;
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("automata_cache");
+}
+
+/*!
+    @name   keyOf
+    @brief  后缀正则表达式对应的缓存键
+    @param  re 后缀正则表达式
+    @param  keepMapping 是否保留状态来源
+    @return SHA-256 十六进制串
+    @attention  格式版本号参与哈希，格式变化后旧缓存自动失效；
+                两种模式分开缓存，生产模式不会读到带 mapping 的自动机
+*/
+QString AutomataCache::keyOf(QString re, bool keepMapping) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray::number(CACHE_VERSION));
+    hash.addData(keepMapping ? "mapping" : "production");
+    hash.addData(re.toUtf8());
+    return QString(hash.result().toHex());
+}
+
+/*!
+    @name   load
+    @brief  读取缓存
+    @param  re 后缀正则表达式
+    @param  keepMapping 是否保留状态来源
+    @param  dfa 读出的 DFA
+    @param  minidfa 读出的最小化 DFA
+    @return 是否命中
+    @attention  文件损坏或哈希碰撞（保存的正则表达式、模式不一致）时视为未命中；
+                命中时更新修改时间，prune 据此淘汰最久未使用的文件
+*/
+bool AutomataCache::load(QString re, bool keepMapping, DFA &dfa, DFA &minidfa) {
+    QFile file(QDir(directory()).filePath(keyOf(re, keepMapping)));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    QString cachedRe;
+    bool cachedKeepMapping;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) return false;
+    in >> cachedRe >> cachedKeepMapping;
+    if (cachedRe != re || cachedKeepMapping != keepMapping) return false;
+    in >> dfa >> minidfa;
+    if (in.status() != QDataStream::Ok) return false;
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+/*!
+    @name   save
+    @brief  写入缓存
+    @param  re 后缀正则表达式
+    @param  keepMapping 是否保留状态来源
+    @param  dfa
+    @param  minidfa
+    @return
+    @attention  先写临时文件再替换，多个线程同时写不同的键互不影响；不在此清理，由调用者构造完成后调用 prune
+*/
+void AutomataCache::save(QString re, bool keepMapping, const DFA &dfa, const DFA &minidfa) {
+    QDir().mkpath(directory());
+    QSaveFile file(QDir(directory()).filePath(keyOf(re, keepMapping)));
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << CACHE_MAGIC << CACHE_VERSION << re << keepMapping << dfa << minidfa;
+    file.commit();
+}
+
+/*!
+    @name   prune
+    @brief  删除超出 maxEntries 的最久未使用的缓存文件
+    @param
+    @return
+    @attention  按修改时间（最近使用时间）从新到旧保留，要遍历整个目录，每次构造后在主线程调用一次；缓存文件名没有扩展名，带扩展名的是 QSaveFile 正在写入的临时文件，不参与计数
+*/
+void AutomataCache::prune() {
+    QFileInfoList entries;
+    for (QFileInfo entry: QDir(directory()).entryInfoList(QDir::Files, QDir::Time)) {
+        if (entry.suffix().isEmpty()) entries.append(entry);
+    }
+    for (int i = maxEntries; i < entries.size(); i++) {
+        QFile::remove(entries[i].filePath());
+    }
+}
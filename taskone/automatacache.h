@@ -0,0 +1,42 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    automatacache.h
+*  @brief   自动机磁盘缓存头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef AUTOMATACACHE_H
+#define AUTOMATACACHE_H
+
+#include <QString>
+
+#include "dfa.h"
+
+/*!
+    @name  AutomataCache
+    @brief 以后缀正则表达式与是否保留状态来源的哈希为键，在磁盘上缓存 DFA 与最小化 DFA；
+           缓存文件数超过 maxEntries 时删除最久未使用的
+*/
+class AutomataCache
+{
+public:
+    static QString cacheDir;                    // 缓存目录，为空时使用系统缓存目录下的 automata_cache
+    static int maxEntries;                      // 最多保留的缓存文件数
+
+    static QString directory();                 // 实际使用的缓存目录
+    static QString keyOf(QString re, bool keepMapping);         // 后缀正则表达式对应的缓存键
+    static bool load(QString re, bool keepMapping, DFA &dfa, DFA &minidfa);        // 读取缓存，未命中返回 false
+    static void save(QString re, bool keepMapping, const DFA &dfa, const DFA &minidfa);    // 写入缓存
+    static void prune();                        // 删除超出 maxEntries 的最久未使用的缓存文件，每次构造后调用一次
+};
+
+#endif // AUTOMATACACHE_H
@@ -0,0 +1,124 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    automatonmodel.cpp
+*  @brief   自动机状态转移表模型实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "automatonmodel.h"
+
+#include <QColor>
+
+NFATableModel::NFATableModel(const NFA &nfa, QObject *parent):
+    QAbstractTableModel(parent), nfa(nfa) {
+    for (QString item: nfa.stateSet) {
+        columnIndex[item] = columns.size();
+        columns << item;
+    }
+}
+
+int NFATableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : nfa.stateNum;
+}
+
+int NFATableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : columns.size();
+}
+
+/*!
+    @name   row
+    @brief  计算第 i 行所有单元格的文本
+    @param  i 状态编号
+    @return 该行各列的文本
+    @attention  只扫描邻接矩阵的一行，代价 O(n)；同一行只计算一次
+*/
+const QVector<QString> &NFATableModel::row(int i) const {
+    auto it = rows.constFind(i);
+    if (it != rows.constEnd()) return it.value();
+
+    QVector<QString> cells(columns.size());
+    const QVector<QString> &edges = nfa.G[i];
+    for (int k = 0; k < nfa.stateNum; k++) {
+        if (edges[k].isEmpty()) continue;
+        auto column = columnIndex.constFind(edges[k]);
+        if (column == columnIndex.constEnd()) continue;
+        QString &cell = cells[column.value()];
+        if (!cell.isEmpty()) cell += ",";
+        cell += QString::number(k);
+    }
+    return rows.insert(i, cells).value();
+}
+
+QVariant NFATableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    return row(index.row())[index.column()];
+}
+
+QVariant NFATableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal) {
+        if (role == Qt::DisplayRole && section < columns.size()) return columns[section];
+        return QVariant();
+    }
+    // 始态绿色、终态红色
+    if (role == Qt::DisplayRole) return QString::number(section);
+    if (role == Qt::ForegroundRole) {
+        if (section == nfa.startState) return QColor(0, 255, 0);
+        if (section == nfa.endState) return QColor(255, 0, 0);
+    }
+    return QVariant();
+}
+
+DFATableModel::DFATableModel(const DFA &dfa, QObject *parent):
+    QAbstractTableModel(parent), dfa(dfa) {
+    for (QString item: dfa.changeSet) {
+        if (item == "epsilon") continue;
+        columns << item;
+    }
+}
+
+int DFATableModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : dfa.stateNum;
+}
+
+int DFATableModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : columns.size();
+}
+
+QVariant DFATableModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    auto edges = dfa.G.constFind(index.row());
+    if (edges == dfa.G.constEnd()) return QVariant();
+    auto target = edges.value().constFind(columns[index.column()]);
+    if (target == edges.value().constEnd()) return QVariant();
+
+    // 目标状态:{来源状态集合}
+    int k = target.value();
+    QStringList source;
+    for (int item: dfa.mapping.value(k)) {
+        source << QString::number(item);
+    }
+    return QString::number(k) + ":{" + source.join(",") + "}";
+}
+
+QVariant DFATableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal) {
+        if (role == Qt::DisplayRole && section < columns.size()) return columns[section];
+        return QVariant();
+    }
+    // 始态绿色、终态红色
+    if (role == Qt::DisplayRole) return QString::number(section);
+    if (role == Qt::ForegroundRole) {
+        if (section == dfa.startState) return QColor(0, 255, 0);
+        if (dfa.endStates.contains(section)) return QColor(255, 0, 0);
+    }
+    return QVariant();
+}
@@ -0,0 +1,70 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    automatonmodel.h
+*  @brief   自动机状态转移表模型头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef AUTOMATONMODEL_H
+#define AUTOMATONMODEL_H
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+
+#include "nfa.h"
+#include "dfa.h"
+
+/*!
+    @name  NFATableModel
+    @brief NFA 状态转移表模型：视图请求某一行时才扫描邻接矩阵的该行，结果按行缓存
+*/
+class NFATableModel : public QAbstractTableModel
+{
+public:
+    NFATableModel(const NFA &nfa, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    const QVector<QString> &row(int i) const;   // 计算并缓存第 i 行
+
+    NFA nfa;                                    // 隐式共享，不复制邻接矩阵
+    QStringList columns;                        // 转移字符，即列标题
+    QHash<QString, int> columnIndex;            // 转移字符到列号
+    mutable QHash<int, QVector<QString>> rows;  // 已计算的行
+};
+
+/*!
+    @name  DFATableModel
+    @brief DFA 状态转移表模型：单元格文本（目标状态及其来源集合）在视图请求时才生成
+*/
+class DFATableModel : public QAbstractTableModel
+{
+public:
+    DFATableModel(const DFA &dfa, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    DFA dfa;                                    // 隐式共享，不复制转移
+    QStringList columns;                        // 转移字符，即列标题
+};
+
+#endif // AUTOMATONMODEL_H
@@ -0,0 +1,313 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    derivative.cpp
+*  @brief   正则表达式导数（Brzozowski）构造DFA实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "derivative.h"
+
+#include <QStack>
+#include <QDebug>
+
+#include <algorithm>
+
+DerivativeEngine::DerivativeEngine() {
+    this->clear();
+}
+
+/*!
+    @name   clear
+    @brief  清空项表，编号 0 为空语言，编号 1 为空串
+    @param
+    @return
+    @attention
+*/
+void DerivativeEngine::clear() {
+    terms.clear();
+    termHash.clear();
+    deriveCache.clear();
+    alphabet.clear();
+    intern(DerivativeTerm::Empty);
+    intern(DerivativeTerm::Epsilon);
+}
+
+/*!
+    @name   fromRegex
+    @brief  将后缀正则表达式转换为规范化的项
+    @param  re 正则表达式
+    @return 项编号
+    @attention  re 是正则表达式的后缀形式，运算符与 NFA::fromRegex 一致
+*/
+int DerivativeEngine::fromRegex(QString re) {
+    QStack<int> stk;
+    for (int i = 0; i < re.size(); i++) {
+        switch (re[i].unicode()) {
+        case '\\':
+            i++;
+            if (i < re.size()) stk.push(chr(QString(re[i])));
+            break;
+        case '|':
+        case '.': {
+            if (stk.size() < 2) throw QString("Derivative build ERROR!!!");
+            int right = stk.pop();
+            int left = stk.pop();
+            stk.push(re[i] == '|' ? alt(left, right) : cat(left, right));
+            break;
+        }
+        case '*':
+        case '+':
+        case '?': {
+            if (stk.empty()) throw QString("Derivative build ERROR!!!");
+            int item = stk.pop();
+            if (re[i] == '*') stk.push(star(item));
+            else if (re[i] == '+') stk.push(cat(item, star(item)));
+            else stk.push(alt(item, epsilon()));
+            break;
+        }
+        case '#':
+            stk.push(epsilon());
+            break;
+        default:
+            stk.push(chr(QString(re[i])));
+            break;
+        }
+    }
+    if (stk.size() != 1) {
+        throw QString("Derivative build ERROR!!!");
+    }
+    return stk.top();
+}
+
+/*!
+    @name   intern
+    @brief  哈希共享：相同的项只分配一个编号
+    @param  type 项类型
+    @param  left 左子项
+    @param  right 右子项
+    @param  ch 字符
+    @return 项编号
+    @attention
+*/
+int DerivativeEngine::intern(DerivativeTerm::Type type, int left, int right, QString ch) {
+    QString key = QString::number(type) + " " + QString::number(left) + " " + QString::number(right) + " " + ch;
+    if (termHash.contains(key)) return termHash[key];
+
+    DerivativeTerm term;
+    term.type = type;
+    term.left = left;
+    term.right = right;
+    term.ch = ch;
+    switch (type) {
+    case DerivativeTerm::Epsilon:
+    case DerivativeTerm::Star:
+        term.nullable = true;
+        break;
+    case DerivativeTerm::Alt:
+        term.nullable = terms[left].nullable || terms[right].nullable;
+        break;
+    case DerivativeTerm::Cat:
+    case DerivativeTerm::And:
+        term.nullable = terms[left].nullable && terms[right].nullable;
+        break;
+    case DerivativeTerm::Not:
+        term.nullable = !terms[left].nullable;
+        break;
+    default:
+        term.nullable = false;
+        break;
+    }
+    terms.append(term);
+    termHash[key] = terms.size() - 1;
+    return terms.size() - 1;
+}
+
+/*!
+    @name   flatten
+    @brief  展开同类型的嵌套二元项
+    @param  type 项类型（Alt 或 And）
+    @param  term 项编号
+    @return 操作数列表
+    @attention
+*/
+QList<int> DerivativeEngine::flatten(DerivativeTerm::Type type, int term) {
+    if (terms[term].type != type) return QList<int>({term});
+    return flatten(type, terms[term].left) + flatten(type, terms[term].right);
+}
+
+/*!
+    @name   fold
+    @brief  操作数排序去重后右结合地重新构造，保证交换律、结合律、幂等律下形式唯一
+    @param  type 项类型（Alt 或 And）
+    @param  operands 操作数列表
+    @return 项编号
+    @attention  operands 不能为空
+*/
+int DerivativeEngine::fold(DerivativeTerm::Type type, QList<int> operands) {
+    std::sort(operands.begin(), operands.end());
+    operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+    int result = operands.last();
+    for (int i = operands.size() - 2; i >= 0; i--) {
+        result = intern(type, operands[i], result);
+    }
+    return result;
+}
+
+int DerivativeEngine::empty() {
+    return 0;
+}
+
+int DerivativeEngine::epsilon() {
+    return 1;
+}
+
+int DerivativeEngine::chr(QString value) {
+    alphabet.insert(value);
+    return intern(DerivativeTerm::Char, -1, -1, value);
+}
+
+/*!
+    @name   alt
+    @brief  或：∅|r = r，r|r = r，¬∅|r = ¬∅
+    @param  a
+    @param  b
+    @return 项编号
+    @attention
+*/
+int DerivativeEngine::alt(int a, int b) {
+    int full = complement(empty());
+    QList<int> operands;
+    for (int item: flatten(DerivativeTerm::Alt, a) + flatten(DerivativeTerm::Alt, b)) {
+        if (item == full) return full;
+        if (item != empty()) operands.append(item);
+    }
+    if (operands.empty()) return empty();
+    return fold(DerivativeTerm::Alt, operands);
+}
+
+/*!
+    @name   cat
+    @brief  连接：∅r = r∅ = ∅，εr = rε = r，(rs)t = r(st)
+    @param  a
+    @param  b
+    @return 项编号
+    @attention
+*/
+int DerivativeEngine::cat(int a, int b) {
+    if (a == empty() || b == empty()) return empty();
+    if (a == epsilon()) return b;
+    if (b == epsilon()) return a;
+    if (terms[a].type == DerivativeTerm::Cat) {
+        int left = terms[a].left;
+        int right = terms[a].right;
+        return cat(left, cat(right, b));
+    }
+    return intern(DerivativeTerm::Cat, a, b);
+}
+
+/*!
+    @name   star
+    @brief  闭包：∅* = ε* = ε，(r*)* = r*
+    @param  a
+    @return 项编号
+    @attention
+*/
+int DerivativeEngine::star(int a) {
+    if (a == empty() || a == epsilon()) return epsilon();
+    if (terms[a].type == DerivativeTerm::Star) return a;
+    return intern(DerivativeTerm::Star, a);
+}
+
+/*!
+    @name   conj
+    @brief  交：∅&r = ∅，r&r = r，¬∅&r = r
+    @param  a
+    @param  b
+    @return 项编号
+    @attention
+*/
+int DerivativeEngine::conj(int a, int b) {
+    int full = complement(empty());
+    QList<int> operands;
+    for (int item: flatten(DerivativeTerm::And, a) + flatten(DerivativeTerm::And, b)) {
+        if (item == empty()) return empty();
+        if (item != full) operands.append(item);
+    }
+    if (operands.empty()) return full;
+    return fold(DerivativeTerm::And, operands);
+}
+
+/*!
+    @name   complement
+    @brief  补：¬¬r = r
+    @param  a
+    @return 项编号
+    @attention  补集相对于 alphabet 中出现的字符
+*/
+int DerivativeEngine::complement(int a) {
+    if (terms[a].type == DerivativeTerm::Not) return terms[a].left;
+    return intern(DerivativeTerm::Not, a);
+}
+
+/*!
+    @name   nullable
+    @brief  项是否可以匹配空串
+    @param  term 项编号
+    @return
+    @attention
+*/
+bool DerivativeEngine::nullable(int term) {
+    return terms[term].nullable;
+}
+
+/*!
+    @name   derive
+    @brief  求项关于字符 value 的 Brzozowski 导数
+    @param  term 项编号
+    @param  value 字符
+    @return 导数项编号
+    @attention  结果经过规范化并缓存
+*/
+int DerivativeEngine::derive(int term, QString value) {
+    if (deriveCache[term].contains(value)) return deriveCache[term][value];
+
+    // terms 会在求导过程中扩容，不能持有引用
+    DerivativeTerm item = terms[term];
+    int result = empty();
+    switch (item.type) {
+    case DerivativeTerm::Empty:
+    case DerivativeTerm::Epsilon:
+        result = empty();
+        break;
+    case DerivativeTerm::Char:
+        result = item.ch == value ? epsilon() : empty();
+        break;
+    case DerivativeTerm::Alt:
+        result = alt(derive(item.left, value), derive(item.right, value));
+        break;
+    case DerivativeTerm::Cat:
+        result = cat(derive(item.left, value), item.right);
+        if (nullable(item.left)) result = alt(result, derive(item.right, value));
+        break;
+    case DerivativeTerm::Star:
+        result = cat(derive(item.left, value), term);
+        break;
+    case DerivativeTerm::And:
+        result = conj(derive(item.left, value), derive(item.right, value));
+        break;
+    case DerivativeTerm::Not:
+        result = complement(derive(item.left, value));
+        break;
+    }
+    deriveCache[term][value] = result;
+    return result;
+}
@@ -0,0 +1,78 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    derivative.h
+*  @brief   正则表达式导数（Brzozowski）构造DFA头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef DERIVATIVE_H
+#define DERIVATIVE_H
+
+#include <QString>
+#include <QSet>
+#include <QList>
+#include <QVector>
+#include <QHash>
+
+/*!
+    @name  DerivativeTerm
+    @brief 规范化后的正则表达式项，通过编号相互引用
+*/
+class DerivativeTerm
+{
+public:
+    enum Type { Empty, Epsilon, Char, Alt, Cat, Star, And, Not };
+
+    Type type;          // 项类型
+    QString ch;         // Char 项的字符
+    int left;           // 左子项编号
+    int right;          // 右子项编号
+    bool nullable;      // 是否可以匹配空串
+};
+
+/*!
+    @name  DerivativeEngine
+    @brief 项表：所有项经过智能构造函数规范化后哈希共享，相同的项只有一个编号
+*/
+class DerivativeEngine
+{
+public:
+    DerivativeEngine();
+    void clear();                       // 清空项表
+    int fromRegex(QString re);          // 利用后缀正则表达式构造项
+
+    // 智能构造函数
+    int empty();                        // 空语言
+    int epsilon();                      // 空串
+    int chr(QString value);             // 单个字符
+    int alt(int a, int b);              // 或
+    int cat(int a, int b);              // 连接
+    int star(int a);                    // 闭包
+    int conj(int a, int b);             // 交
+    int complement(int a);              // 补
+
+    int derive(int term, QString value);    // 求项关于字符 value 的导数
+    bool nullable(int term);                // 项是否可以匹配空串
+
+    QVector<DerivativeTerm> terms;      // 项表
+    QSet<QString> alphabet;             // 正则表达式中出现的字符
+
+private:
+    int intern(DerivativeTerm::Type type, int left = -1, int right = -1, QString ch = "");
+    QList<int> flatten(DerivativeTerm::Type type, int term);
+    int fold(DerivativeTerm::Type type, QList<int> operands);
+
+    QHash<QString, int> termHash;                   // 项到编号的映射
+    QHash<int, QHash<QString, int>> deriveCache;    // 导数缓存
+};
+
+#endif // DERIVATIVE_H
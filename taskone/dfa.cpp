@@ -15,10 +15,96 @@
 *****************************************************************************
 */
 #include "dfa.h"
+#include "derivative.h"
 
 #include <QQueue>
+#include <QtConcurrent>
 #include <QDebug>
 
+#include <algorithm>
+
+DFATable::DFATable(): stateNum(0), classNum(1), startState(0), deadState(0), stateWidth(1) {
+    classMap.fill(0, 256 * sizeof(quint16));
+    acceptBits.fill(0, sizeof(quint32));
+}
+
+/*!
+    @name   runLanes
+    @brief  matchLanes 的实现，T 为状态编号的类型
+    @param  t 转移表
+    @param  next 连续存储的转移表
+    @param  text 各输入流的起点
+    @param  length 各输入流的长度
+    @param  lanes 输入流数量
+    @param  matchLen 写入各输入流的最长匹配长度，无法匹配时为 -1
+    @return
+    @attention  内层循环遍历输入流，各输入流的查表互不依赖，访存延迟可以相互重叠；
+                停止的输入流状态置为死状态，不再参与后续轮次
+*/
+template <typename T>
+static void runLanes(const DFATable &t, const T *next, const QChar *const *text, const int *length, int lanes, int *matchLen) {
+    int state[DFATable::MAX_LANES];
+    int active = 0;
+    for (int l = 0; l < lanes; l++) {
+        state[l] = t.startState;
+        matchLen[l] = t.isAccept(t.startState) ? 0 : -1;
+        if (length[l] > 0) active++;
+        else state[l] = t.deadState;
+    }
+    for (int i = 0; active > 0; i++) {
+        for (int l = 0; l < lanes; l++) {
+            if (state[l] == t.deadState) continue;
+            int s = next[state[l] * t.classNum + t.charClass(text[l][i])];
+            if (s != t.deadState && t.isAccept(s)) matchLen[l] = i + 1;
+            if (s == t.deadState || i + 1 >= length[l]) {
+                s = t.deadState;
+                active--;
+            }
+            state[l] = s;
+        }
+    }
+}
+
+/*!
+    @name   matchLanes
+    @brief  多个输入流交错运行的最长匹配
+    @param  text 各输入流的起点
+    @param  length 各输入流的长度
+    @param  lanes 输入流数量，不超过 MAX_LANES
+    @param  matchLen 写入各输入流的最长匹配长度，无法匹配时为 -1
+    @return
+    @attention  所有输入流同步前进一个字符再进入下一轮，结果与逐个调用单流循环相同；
+                状态编号宽度在进入循环前确定，循环内不再分支
+*/
+void DFATable::matchLanes(const QChar *const *text, const int *length, int lanes, int *matchLen) const {
+    switch (stateWidth) {
+    case 1:
+        runLanes(*this, reinterpret_cast<const quint8 *>(table.constData()), text, length, lanes, matchLen);
+        break;
+    case 2:
+        runLanes(*this, reinterpret_cast<const quint16 *>(table.constData()), text, length, lanes, matchLen);
+        break;
+    default:
+        runLanes(*this, reinterpret_cast<const quint32 *>(table.constData()), text, length, lanes, matchLen);
+        break;
+    }
+}
+
+/*!
+    @name   detach
+    @brief  复制各数组，使转移表不再引用外部内存
+    @param
+    @return
+    @attention  由 DFAImage 载入的表用 fromRawData 指向映射内存，拷贝 DFATable 只是共享同一块内存；
+                交给其他线程长期使用前调用，镜像重新载入或销毁后仍然有效
+*/
+void DFATable::detach() {
+    table.detach();
+    classMap.detach();
+    wideClass.detach();
+    acceptBits.detach();
+}
+
 DFA::DFA():startState(0), stateNum(0) {
     this->clear();
 }
@@ -27,10 +113,11 @@ DFA::DFA():startState(0), stateNum(0) {
     @name   fromNFA
     @brief  NFA 转换为 DFA
     @param  nfa
+    @param  keepMapping 是否保留 mapping
     @return
-    @attention
+    @attention  不保留 mapping 时每个状态处理完即从 mapping 中取出，mapping 只含尚未处理的状态
 */
-void DFA::fromNFA(NFA nfa) {
+void DFA::fromNFA(NFA nfa, bool keepMapping) {
     changeSet = nfa.stateSet;
     QHash<QSet<int>, int> revMapping;
     // 获取始态
@@ -39,7 +126,7 @@ void DFA::fromNFA(NFA nfa) {
     startSet = nfa.epsilonClosure(startSet);
     mapping[startState] = startSet;
     revMapping[startSet] = startState;
-    if (startSet.contains(nfa.endState)) {
+    if (startSet.intersects(nfa.acceptStates)) {
         endStates.insert(startState);
     }
     stateNum++;
@@ -53,7 +140,8 @@ void DFA::fromNFA(NFA nfa) {
         int stateItem = q.front();
 
         q.pop_front();
-        QSet<int> nfaStateSet = mapping[stateItem];
+        if (!mapping.contains(stateItem)) continue;     // 重复入队，已经处理并释放
+        QSet<int> nfaStateSet = keepMapping ? mapping[stateItem] : mapping.take(stateItem);
 
         // 未曾出现过的状态集合才需要查找
         if (!vis.contains(nfaStateSet)) {
@@ -73,7 +161,7 @@ void DFA::fromNFA(NFA nfa) {
                         int nextItem = revMapping[changeEpsilon];
 
                         G[stateItem][changeItem] = nextItem;
-                        if (changeEpsilon.contains(nfa.endState)) {
+                        if (changeEpsilon.intersects(nfa.acceptStates)) {
                             endStates.insert(nextItem);
                         }
 
@@ -86,7 +174,7 @@ void DFA::fromNFA(NFA nfa) {
                         revMapping[changeEpsilon] = nextItem;
 
                         G[stateItem][changeItem] = nextItem;
-                        if (changeEpsilon.contains(nfa.endState)) {
+                        if (changeEpsilon.intersects(nfa.acceptStates)) {
                             endStates.insert(nextItem);
                         }
                         stateNum++;
@@ -102,14 +190,99 @@ void DFA::fromNFA(NFA nfa) {
     }
 }
 
+/*!
+    @name  SuccessorFunctor
+    @brief 计算一个 DFA 状态（NFA 状态集合）在每个字符上的后继集合，供线程池调用
+*/
+class SuccessorFunctor
+{
+public:
+    typedef QVector<QSet<int>> result_type;
+
+    SuccessorFunctor(const NFA *nfa, const QList<QString> *alphabet): nfa(nfa), alphabet(alphabet) {}
+
+    QVector<QSet<int>> operator()(const QSet<int> &nfaStateSet) const {
+        QVector<QSet<int>> successors;
+        for (QString changeItem: *alphabet) {
+            successors.append(nfa->valueClosure(nfaStateSet, changeItem));
+        }
+        return successors;
+    }
+
+    const NFA *nfa;
+    const QList<QString> *alphabet;
+};
+
+/*!
+    @name   fromNFAParallel
+    @brief  NFA 转换为 DFA 的并行版本
+    @param  nfa
+    @param  keepMapping 是否保留 mapping
+    @return
+    @attention  按广度优先的层推进：同一层所有状态的闭包在线程池中并行计算，
+                再按（层内顺序, 字符顺序）串行编号，因此结果与线程数无关、编号确定；
+                不保留 mapping 时每层取出后即从 mapping 中释放
+*/
+void DFA::fromNFAParallel(NFA nfa, bool keepMapping) {
+    changeSet = nfa.stateSet;
+    QList<QString> alphabet;
+    for (QString changeItem: nfa.stateSet) {
+        if (changeItem != "epsilon") alphabet.append(changeItem);
+    }
+    std::sort(alphabet.begin(), alphabet.end());
+
+    // 获取始态
+    QHash<QSet<int>, int> revMapping;
+    QSet<int> startSet = nfa.epsilonClosure(QSet<int>({nfa.startState}));
+    mapping[startState] = startSet;
+    revMapping[startSet] = startState;
+    if (startSet.intersects(nfa.acceptStates)) {
+        endStates.insert(startState);
+    }
+    stateNum++;
+
+    QVector<int> frontier({startState});
+    while (!frontier.empty()) {
+        QList<QSet<int>> frontierSets;
+        for (int stateItem: frontier) {
+            frontierSets.append(keepMapping ? mapping[stateItem] : mapping.take(stateItem));
+        }
+
+        // 并行计算后继集合
+        QList<QVector<QSet<int>>> successors = QtConcurrent::blockingMapped(frontierSets, SuccessorFunctor(&nfa, &alphabet));
+
+        // 串行去重编号
+        QVector<int> nextFrontier;
+        for (int i = 0; i < frontier.size(); i++) {
+            for (int j = 0; j < alphabet.size(); j++) {
+                const QSet<int> &changeEpsilon = successors[i][j];
+                if (changeEpsilon.empty()) continue;
+                if (!revMapping.contains(changeEpsilon)) {
+                    int nextItem = stateNum;
+                    mapping[nextItem] = changeEpsilon;
+                    revMapping[changeEpsilon] = nextItem;
+                    if (changeEpsilon.intersects(nfa.acceptStates)) {
+                        endStates.insert(nextItem);
+                    }
+                    stateNum++;
+                    nextFrontier.append(nextItem);
+                }
+                G[frontier[i]][alphabet[j]] = revMapping[changeEpsilon];
+            }
+        }
+        frontier = nextFrontier;
+    }
+}
+
 /*!
     @name   fromDFA
     @brief  DFA 最小化
     @param  dfa
+    @param  keepMapping 是否保留 mapping
     @return
-    @attention
+    @attention  编号只依赖 revMapping，不保留 mapping 时不记录，需要展示时由 mappingFromDFA 按需恢复
 */
-void DFA::fromDFA(DFA dfa) {
+void DFA::fromDFA(DFA dfa, bool keepMapping) {
     changeSet = dfa.changeSet;
     QSet<int> notEndStates;
     for (int i = 0; i < dfa.stateNum; i++) {
@@ -188,7 +361,7 @@ void DFA::fromDFA(DFA dfa) {
     QHash<QSet<int>, int> revMapping;
     for (QSet<int> queueItem: q) {
         if (queueItem.empty()) continue;
-        mapping[idx] = queueItem;
+        if (keepMapping) mapping[idx] = queueItem;
         revMapping[queueItem] = idx;
         idx++;
     }
@@ -225,6 +398,432 @@ void DFA::fromDFA(DFA dfa) {
             }
         }
     }
+
+    buildTable();
+}
+
+/*!
+    @name   fromDerivative
+    @brief  利用 Brzozowski 导数由后缀正则表达式直接构造 DFA
+    @param  re 后缀正则表达式
+    @return
+    @attention  每个 DFA 状态对应一个规范化的项，mapping 中记录该项在项表中的编号；
+                导数为空语言的转移不记录，与 fromNFA 得到的部分转移表一致
+*/
+void DFA::fromDerivative(QString re) {
+    DerivativeEngine engine;
+    int startTerm = engine.fromRegex(re);
+    changeSet = engine.alphabet;
+
+    // 按字符排序保证状态编号确定
+    QList<QString> alphabet = engine.alphabet.values();
+    std::sort(alphabet.begin(), alphabet.end());
+
+    QHash<int, int> revMapping;     // 项编号到 DFA 状态的映射
+    mapping[startState] = QSet<int>({startTerm});
+    revMapping[startTerm] = startState;
+    if (engine.nullable(startTerm)) {
+        endStates.insert(startState);
+    }
+    stateNum++;
+
+    QQueue<int> q;
+    q.push_back(startState);
+    while (!q.empty()) {
+        int stateItem = q.front();
+        q.pop_front();
+        int term = *mapping[stateItem].begin();
+
+        for (QString changeItem: alphabet) {
+            int nextTerm = engine.derive(term, changeItem);
+            if (nextTerm == engine.empty()) continue;
+
+            if (!revMapping.contains(nextTerm)) {
+                int nextItem = stateNum;
+                mapping[nextItem] = QSet<int>({nextTerm});
+                revMapping[nextTerm] = nextItem;
+                if (engine.nullable(nextTerm)) {
+                    endStates.insert(nextItem);
+                }
+                stateNum++;
+                q.push_back(nextItem);
+            }
+            G[stateItem][changeItem] = revMapping[nextTerm];
+        }
+    }
+
+    buildTable();
+}
+
+/*!
+    @name   fromProduct
+    @brief  两个 DFA 的乘积构造，得到交集或差集语言的 DFA
+    @param  a 左操作数
+    @param  b 右操作数
+    @param  op '&' 表示 a 与 b 的交，'-' 表示 a 减去 b
+    @return
+    @attention  缺失的转移视为进入死状态（编号 -1）；mapping 记录乘积状态对应的非死分量状态
+*/
+void DFA::fromProduct(DFA a, DFA b, QChar op) {
+    if (op != '&' && op != '-') {
+        throw QString("DFA product ERROR!!!");
+    }
+    changeSet = a.changeSet;
+    changeSet.unite(b.changeSet);
+    changeSet.remove("epsilon");
+
+    // 按字符排序保证状态编号确定
+    QList<QString> alphabet = changeSet.values();
+    std::sort(alphabet.begin(), alphabet.end());
+
+    QHash<QPair<int, int>, int> revMapping;
+    QHash<int, QPair<int, int>> pairMapping;
+    QQueue<int> q;
+
+    QPair<int, int> startPair(a.startState, b.startState);
+    pairMapping[startState] = startPair;
+    revMapping[startPair] = startState;
+    stateNum++;
+    q.push_back(startState);
+
+    while (!q.empty()) {
+        int stateItem = q.front();
+        q.pop_front();
+        QPair<int, int> statePair = pairMapping[stateItem];
+
+        // 记录分量状态并判断是否为终态
+        mapping[stateItem] = QSet<int>();
+        if (statePair.first != -1) mapping[stateItem].insert(statePair.first);
+        if (statePair.second != -1) mapping[stateItem].insert(statePair.second);
+        bool aEnd = a.endStates.contains(statePair.first);
+        bool bEnd = b.endStates.contains(statePair.second);
+        if ((op == '&' && aEnd && bEnd) || (op == '-' && aEnd && !bEnd)) {
+            endStates.insert(stateItem);
+        }
+
+        for (QString changeItem: alphabet) {
+            int aNext = -1, bNext = -1;
+            if (statePair.first != -1 && a.G[statePair.first].contains(changeItem)) {
+                aNext = a.G[statePair.first][changeItem];
+            }
+            if (statePair.second != -1 && b.G[statePair.second].contains(changeItem)) {
+                bNext = b.G[statePair.second][changeItem];
+            }
+
+            // 交运算任一分量死亡、差运算左分量死亡后不可能再接受
+            if (aNext == -1) continue;
+            if (op == '&' && bNext == -1) continue;
+
+            QPair<int, int> nextPair(aNext, bNext);
+            if (!revMapping.contains(nextPair)) {
+                int nextItem = stateNum;
+                pairMapping[nextItem] = nextPair;
+                revMapping[nextPair] = nextItem;
+                stateNum++;
+                q.push_back(nextItem);
+            }
+            G[stateItem][changeItem] = revMapping[nextPair];
+        }
+    }
+}
+
+/*!
+    @name   fromWords
+    @brief  字面量集合直接构造字典树 DFA
+    @param  words 字面量
+    @return
+    @attention  跳过 NFA 与子集构造，没有状态来源，展示时由 mappingFromNFA 恢复
+*/
+void DFA::fromWords(QStringList words) {
+    stateNum = 1;
+    for (QString word: words) {
+        int state = startState;
+        for (QChar c: word) {
+            QString changeItem(c);
+            changeSet.insert(changeItem);
+            if (!G[state].contains(changeItem)) {
+                G[state][changeItem] = stateNum++;
+            }
+            state = G[state][changeItem];
+        }
+        endStates.insert(state);
+    }
+    buildTable();
+}
+
+/*!
+    @name   buildTable
+    @brief  生成定型后的连续转移表
+    @param
+    @return
+    @attention  所有状态上转移完全相同的字符合并为一个字符类；第 0 类为字母表之外的字符，总是进入死状态
+*/
+void DFA::buildTable() {
+    table = DFATable();
+    table.stateNum = stateNum;
+    table.startState = startState;
+    table.deadState = stateNum;
+    if (stateNum < 0xFF) table.stateWidth = 1;
+    else if (stateNum < 0xFFFF) table.stateWidth = 2;
+    else table.stateWidth = 4;
+
+    // 按字符排序保证字符类编号确定
+    QList<QString> alphabet;
+    for (QString changeItem: changeSet) {
+        if (changeItem.size() == 1) alphabet.append(changeItem);
+    }
+    std::sort(alphabet.begin(), alphabet.end());
+
+    // 转移列相同的字符属于同一个字符类
+    QHash<QString, int> columnHash;
+    QMap<ushort, quint16> wideClass;
+    QVector<QVector<int>> columns;
+    table.classChars.append(QString());
+    columns.append(QVector<int>(stateNum, table.deadState));
+    for (QString changeItem: alphabet) {
+        QVector<int> column(stateNum, table.deadState);
+        QString columnKey = "";
+        for (int i = 0; i < stateNum; i++) {
+            if (G.contains(i) && G[i].contains(changeItem)) column[i] = G[i][changeItem];
+            columnKey += QString::number(column[i]) + ",";
+        }
+        if (!columnHash.contains(columnKey)) {
+            columnHash[columnKey] = columns.size();
+            columns.append(column);
+            table.classChars.append(QString());
+        }
+        int cls = columnHash[columnKey];
+        table.classChars[cls] += changeItem;
+        ushort code = changeItem[0].unicode();
+        if (code < 256) reinterpret_cast<quint16 *>(table.classMap.data())[code] = cls;
+        else wideClass[code] = cls;
+    }
+    table.classNum = columns.size();
+
+    // 非 Latin-1 字符按升序存储，查询时二分
+    table.wideClass.resize(wideClass.size() * 2 * sizeof(quint16));
+    quint16 *pairs = reinterpret_cast<quint16 *>(table.wideClass.data());
+    for (ushort code: wideClass.keys()) {
+        *pairs++ = code;
+        *pairs++ = wideClass[code];
+    }
+
+    // 按 state * classNum + class 连续存储
+    table.table.resize(stateNum * table.classNum * table.stateWidth);
+    for (int i = 0; i < stateNum; i++) {
+        for (int cls = 0; cls < table.classNum; cls++) {
+            int idx = i * table.classNum + cls;
+            switch (table.stateWidth) {
+            case 1:
+                reinterpret_cast<quint8 *>(table.table.data())[idx] = columns[cls][i];
+                break;
+            case 2:
+                reinterpret_cast<quint16 *>(table.table.data())[idx] = columns[cls][i];
+                break;
+            default:
+                reinterpret_cast<quint32 *>(table.table.data())[idx] = columns[cls][i];
+                break;
+            }
+        }
+    }
+
+    // 终态位图
+    table.acceptBits.fill(0, (stateNum / 32 + 1) * sizeof(quint32));
+    quint32 *acceptWords = reinterpret_cast<quint32 *>(table.acceptBits.data());
+    for (int endState: endStates) {
+        acceptWords[endState >> 5] |= 1u << (endState & 31);
+    }
+}
+
+/*!
+    @name   collectWords
+    @brief  深度优先枚举从 state 出发能接受的单词
+    @param  dfa
+    @param  state 当前状态
+    @param  prefix 已读入的前缀
+    @param  onPath 当前路径上的状态，用于发现环
+    @param  result 结果
+    @param  limit 单词数量上限
+    @return 语言有限且单词数量不超过上限时返回 true
+    @attention
+*/
+static bool collectWords(const DFA &dfa, int state, QString &prefix, QSet<int> &onPath, QStringList &result, int limit) {
+    if (dfa.endStates.contains(state)) {
+        result.append(prefix);
+        if (result.size() > limit) return false;
+    }
+    onPath.insert(state);
+    QHash<QString, int> edges = dfa.G.value(state);
+    QStringList changeList = edges.keys();
+    std::sort(changeList.begin(), changeList.end());
+    for (QString changeItem: changeList) {
+        int nextItem = edges[changeItem];
+        if (onPath.contains(nextItem)) return false;    // 有环，语言无限
+        prefix += changeItem;
+        bool ok = collectWords(dfa, nextItem, prefix, onPath, result, limit);
+        prefix.chop(changeItem.size());
+        if (!ok) return false;
+    }
+    onPath.remove(state);
+    return true;
+}
+
+/*!
+    @name   words
+    @brief  枚举有限语言的全部单词
+    @param  result 按字典序排列的单词
+    @param  limit 单词数量上限
+    @return 语言有限且单词数量不超过上限时返回 true
+    @attention  最小化 DFA 没有死状态，从始态可达的环必定使语言无限
+*/
+bool DFA::words(QStringList &result, int limit) const {
+    result.clear();
+    if (stateNum == 0) return true;
+    QString prefix;
+    QSet<int> onPath;
+    if (!collectWords(*this, startState, prefix, onPath, result, limit)) {
+        result.clear();
+        return false;
+    }
+    return true;
+}
+
+/*!
+    @name   bfsOrder
+    @brief  从始态出发的广度优先顺序
+    @param
+    @return 新编号依次对应的旧状态
+    @attention  转移按字符排序，结果确定；不可达状态按原编号排在最后
+*/
+QVector<int> DFA::bfsOrder() {
+    QVector<int> order;
+    QSet<int> vis;
+    QQueue<int> q;
+    q.push_back(startState);
+    vis.insert(startState);
+    while (!q.empty()) {
+        int stateItem = q.front();
+        q.pop_front();
+        order.append(stateItem);
+
+        QList<QString> changeList = G[stateItem].keys();
+        std::sort(changeList.begin(), changeList.end());
+        for (QString changeItem: changeList) {
+            int nextItem = G[stateItem][changeItem];
+            if (!vis.contains(nextItem)) {
+                vis.insert(nextItem);
+                q.push_back(nextItem);
+            }
+        }
+    }
+    for (int i = 0; i < stateNum; i++) {
+        if (!vis.contains(i)) order.append(i);
+    }
+    return order;
+}
+
+/*!
+    @name   frequencyOrder
+    @brief  按样例分词时记录的访问次数降序排列状态
+    @param  visits 每个状态的访问次数
+    @return 新编号依次对应的旧状态
+    @attention  次数相同的状态保持广度优先顺序，结果确定
+*/
+QVector<int> DFA::frequencyOrder(QVector<qint64> visits) {
+    QVector<int> order = bfsOrder();
+    visits.resize(stateNum);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return visits[a] > visits[b];
+    });
+    return order;
+}
+
+/*!
+    @name   renumber
+    @brief  按给定顺序重新编号状态
+    @param  order 新编号依次对应的旧状态
+    @return
+    @attention  同时更新 mapping、G、始态、终态与连续转移表
+*/
+void DFA::renumber(QVector<int> order) {
+    QHash<int, int> newId;
+    for (int i = 0; i < order.size(); i++) {
+        newId[order[i]] = i;
+    }
+
+    QHash<int, QSet<int>> newMapping;
+    QHash<int, QHash<QString, int>> newG;
+    QSet<int> newEndStates;
+    for (int i = 0; i < stateNum; i++) {
+        if (mapping.contains(i)) newMapping[newId[i]] = mapping[i];
+        if (G.contains(i)) {
+            for (QString changeItem: G[i].keys()) {
+                newG[newId[i]][changeItem] = newId[G[i][changeItem]];
+            }
+        }
+        if (endStates.contains(i)) newEndStates.insert(newId[i]);
+    }
+    mapping = newMapping;
+    G = newG;
+    endStates = newEndStates;
+    startState = newId[startState];
+
+    buildTable();
+}
+
+/*!
+    @name   mappingFromNFA
+    @brief  按需恢复子集构造的状态来源
+    @param  nfa 构造本 DFA 时使用的 NFA
+    @return DFA 状态到 NFA 状态集合的映射
+    @attention  从始态出发沿 DFA 的转移同步计算 NFA 的闭包，结果与 fromNFA 记录的 mapping 相同
+*/
+QHash<int, QSet<int>> DFA::mappingFromNFA(const NFA &nfa) const {
+    QHash<int, QSet<int>> result;
+    result[startState] = nfa.epsilonClosure(QSet<int>({nfa.startState}));
+    QQueue<int> q;
+    q.push_back(startState);
+    while (!q.empty()) {
+        int stateItem = q.front();
+        q.pop_front();
+        for (QString changeItem: G.value(stateItem).keys()) {
+            int nextItem = G.value(stateItem).value(changeItem);
+            if (result.contains(nextItem)) continue;
+            result[nextItem] = nfa.valueClosure(result[stateItem], changeItem);
+            q.push_back(nextItem);
+        }
+    }
+    return result;
+}
+
+/*!
+    @name   mappingFromDFA
+    @brief  按需恢复最小化的状态来源
+    @param  dfa 最小化前的 DFA
+    @return 最小化 DFA 状态到原 DFA 状态集合的映射
+    @attention  两个 DFA 从始态同步前进，原 DFA 的每个可达状态恰好对应一个最小化状态
+*/
+QHash<int, QSet<int>> DFA::mappingFromDFA(const DFA &dfa) const {
+    QHash<int, QSet<int>> result;
+    QHash<int, int> dfaToMini;
+    QQueue<int> q;
+    dfaToMini[dfa.startState] = startState;
+    result[startState].insert(dfa.startState);
+    q.push_back(dfa.startState);
+    while (!q.empty()) {
+        int stateItem = q.front();
+        q.pop_front();
+        int miniItem = dfaToMini[stateItem];
+        for (QString changeItem: dfa.G.value(stateItem).keys()) {
+            int nextItem = dfa.G.value(stateItem).value(changeItem);
+            if (dfaToMini.contains(nextItem) || !G.value(miniItem).contains(changeItem)) continue;
+            int nextMini = G.value(miniItem).value(changeItem);
+            dfaToMini[nextItem] = nextMini;
+            result[nextMini].insert(nextItem);
+            q.push_back(nextItem);
+        }
+    }
+    return result;
 }
 
 /*!
@@ -241,3 +840,35 @@ void DFA::clear() {
     stateNum = 0;
     startState = 0;
 }
+
+/*!
+    @name   operator<<
+    @brief  DFA 序列化
+    @param  out 输出流
+    @param  dfa
+    @return 输出流
+    @attention  连续转移表不写入，读入后由 buildTable 重新生成
+*/
+QDataStream &operator<<(QDataStream &out, const DFA &dfa) {
+    out << dfa.mapping << dfa.G << qint32(dfa.startState) << dfa.endStates
+        << qint32(dfa.stateNum) << dfa.changeSet;
+    return out;
+}
+
+/*!
+    @name   operator>>
+    @brief  DFA 反序列化
+    @param  in 输入流
+    @param  dfa
+    @return 输入流
+    @attention
+*/
+QDataStream &operator>>(QDataStream &in, DFA &dfa) {
+    qint32 startState, stateNum;
+    dfa.clear();
+    in >> dfa.mapping >> dfa.G >> startState >> dfa.endStates >> stateNum >> dfa.changeSet;
+    dfa.startState = startState;
+    dfa.stateNum = stateNum;
+    dfa.buildTable();
+    return in;
+}
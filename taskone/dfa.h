@@ -4,17 +4,99 @@
 #include <QHash>
 #include <QSet>
 #include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+#include <QByteArray>
+#include <QDataStream>
 
 #include "nfa.h"
 
+/*!
+    @name  DFATable
+    @brief 定型后的 DFA：转移表按 state * classNum + class 连续存储，
+           状态编号按状态数选用 1/2/4 字节，终态用位图表示
+    @attention 各数组均为原始字节，可以直接指向内存映射的镜像文件（见 DFAImage）
+*/
+class DFATable
+{
+public:
+    DFATable();
+
+    // 查询函数
+    int charClass(QChar c) const {          // 字符所属的字符类，0 表示不在字母表中
+        if (c.unicode() < 256) return latinClass(c.unicode());
+        // 其余字符按 (字符, 字符类) 升序存储，二分查找
+        const quint16 *pairs = reinterpret_cast<const quint16 *>(wideClass.constData());
+        int l = 0, r = wideClass.size() / 4 - 1;
+        while (l <= r) {
+            int mid = (l + r) / 2;
+            if (pairs[2 * mid] == c.unicode()) return pairs[2 * mid + 1];
+            if (pairs[2 * mid] < c.unicode()) l = mid + 1;
+            else r = mid - 1;
+        }
+        return 0;
+    }
+    int latinClass(int c) const {           // 编码小于 256 的字符所属的字符类
+        return reinterpret_cast<const quint16 *>(classMap.constData())[c];
+    }
+    int next(int state, int cls) const {    // 状态转移，返回 deadState 表示无转移
+        int idx = state * classNum + cls;
+        switch (stateWidth) {
+        case 1:
+            return reinterpret_cast<const quint8 *>(table.constData())[idx];
+        case 2:
+            return reinterpret_cast<const quint16 *>(table.constData())[idx];
+        default:
+            return reinterpret_cast<const quint32 *>(table.constData())[idx];
+        }
+    }
+    bool isAccept(int state) const {        // 是否为终态
+        return (acceptWord(state >> 5) >> (state & 31)) & 1;
+    }
+    quint32 acceptWord(int i) const {       // 终态位图的第 i 个字
+        return reinterpret_cast<const quint32 *>(acceptBits.constData())[i];
+    }
+    void matchLanes(const QChar *const *text, const int *length, int lanes, int *matchLen) const;    // 多个输入流交错运行的最长匹配
+    void detach();                      // 复制各数组，不再引用镜像的映射内存
+
+    static const int MAX_LANES = 8;     // matchLanes 一次最多交错的输入流数量
+
+    int stateNum;                       // 状态数量
+    int classNum;                       // 字符类数量（含第 0 类）
+    int startState;                     // 始态
+    int deadState;                      // 死状态编号，等于 stateNum
+    int stateWidth;                     // 每个状态编号占用的字节数
+    QByteArray table;                   // 连续存储的转移表
+    QByteArray classMap;                // 编码小于 256 的字符到字符类的映射，256 个 quint16
+    QByteArray wideClass;               // 其余字符到字符类的映射，按字符升序的 (quint16, quint16) 对
+    QByteArray acceptBits;              // 终态位图，每个 quint32 记录 32 个状态
+    QVector<QString> classChars;        // 每个字符类包含的字符，仅用于展示
+};
+
 class DFA
 {
 public:
     DFA();
     void clear();                       // 清空 DFA
 
-    void fromNFA(NFA nfa);              // NFA 转 DFA
-    void fromDFA(DFA dfa);              // DFA 最小化为 miniDFA
+    void fromNFA(NFA nfa, bool keepMapping = true);             // NFA 转 DFA
+    void fromNFAParallel(NFA nfa, bool keepMapping = true);     // NFA 转 DFA，按层并行计算后继状态集合
+    void fromDFA(DFA dfa, bool keepMapping = true);             // DFA 最小化为 miniDFA
+    void fromDerivative(QString re);    // 正则表达式导数直接构造 DFA
+    void fromProduct(DFA a, DFA b, QChar op);   // 乘积构造：op 为 &（交）或 -（差）
+    void fromWords(QStringList words);  // 字面量集合直接构造字典树 DFA
+    void buildTable();                  // 生成定型后的连续转移表
+    bool words(QStringList &result, int limit) const;   // 枚举有限语言的全部单词
+
+    // 状态重排：热状态编号相邻，提高转移表与生成代码的局部性
+    QVector<int> bfsOrder();                                // 从始态出发的广度优先顺序
+    QVector<int> frequencyOrder(QVector<qint64> visits);    // 按分词时的访问次数降序
+    void renumber(QVector<int> order);                      // 按 order 重新编号
+
+    // 状态来源：生产模式（构造时 keepMapping 为 false）下不保留，展示时按需恢复
+    QHash<int, QSet<int>> mappingFromNFA(const NFA &nfa) const; // 由 NFA 恢复子集构造的 mapping
+    QHash<int, QSet<int>> mappingFromDFA(const DFA &dfa) const; // 由最小化前的 DFA 恢复 mapping
 
     QHash<int, QSet<int>> mapping;      // dfa状态到nfa或dfa状态的映射
     QHash<int, QHash<QString, int>> G;  // 邻接表
@@ -22,6 +104,10 @@ public:
     QSet<int> endStates;                // 终态集合
     int stateNum;                       // 表示状态数量
     QSet<QString> changeSet;            // 转移集合
+    DFATable table;                     // 定型后的连续转移表，由 buildTable 生成
 };
 
+QDataStream &operator<<(QDataStream &out, const DFA &dfa);   // DFA 序列化
+QDataStream &operator>>(QDataStream &in, DFA &dfa);         // DFA 反序列化
+
 #endif // DFA_H
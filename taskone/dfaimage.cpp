@@ -0,0 +1,220 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    dfaimage.cpp
+*  @brief   最小化DFA二进制镜像实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "dfaimage.h"
+
+#include <QSaveFile>
+#include <QByteArray>
+
+#include <cstring>
+
+static const char IMAGE_MAGIC[8] = "SCNUDFA";
+static const quint32 IMAGE_VERSION = 1;
+static const quint32 IMAGE_BYTE_ORDER = 0x01020304;
+static const int IMAGE_ALIGN = 64;
+
+static_assert(sizeof(DFAImageHeader) == 64, "DFAImageHeader must be 64 bytes");
+static_assert(sizeof(DFAImageToken) == 64, "DFAImageToken must be 64 bytes");
+
+/*!
+    @name   appendSection
+    @brief  按 64 字节对齐追加一段数据
+    @param  image 镜像
+    @param  data 数据
+    @return 数据在镜像中的偏移
+    @attention
+*/
+static quint32 appendSection(QByteArray &image, const QByteArray &data) {
+    while (image.size() % IMAGE_ALIGN != 0) image.append('\0');
+    quint32 offset = image.size();
+    image.append(data);
+    return offset;
+}
+
+/*!
+    @name   validTable
+    @brief  扫描一遍转移表与字符类映射的内容
+    @param  table 指向映射内存的转移表
+    @return 是否所有转移目标都不超过死状态、所有字符类都小于字符类数量
+    @attention  边界检查只保证各段在文件内，表项越界会使 next 读到段外，载入时一次性排除
+*/
+static bool validTable(const DFATable &table) {
+    if (table.wideClass.size() % (2 * sizeof(quint16)) != 0) return false;
+    for (int c = 0; c < 256; c++) {
+        if (table.latinClass(c) >= table.classNum) return false;
+    }
+    const quint16 *pairs = reinterpret_cast<const quint16 *>(table.wideClass.constData());
+    for (int i = 0; i < table.wideClass.size() / 4; i++) {
+        if (pairs[2 * i + 1] >= table.classNum) return false;
+    }
+    for (int state = 0; state < table.stateNum; state++) {
+        for (int cls = 0; cls < table.classNum; cls++) {
+            if (quint32(table.next(state, cls)) > quint32(table.stateNum)) return false;
+        }
+    }
+    return true;
+}
+
+DFAImage::DFAImage(): utf8(false) {
+}
+
+/*!
+    @name   save
+    @brief  写入镜像
+    @param  fileName 文件名
+    @param  names 单词名称，下标即单词编号
+    @param  tables 与 names 对应的转移表
+    @param  utf8 是否为 UTF-8 字节自动机
+    @return 是否成功
+    @attention  按本机字节序写入，载入时检查；没有状态的转移表无法载入，不写入
+*/
+bool DFAImage::save(QString fileName, QStringList names, QVector<DFATable> tables, bool utf8) {
+    DFAImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.byteOrder = IMAGE_BYTE_ORDER;
+    header.flags = utf8 ? 1 : 0;
+    header.tokenNum = names.size();
+    header.tokenOffset = sizeof(DFAImageHeader);
+    for (const DFATable &table: tables) {
+        if (table.stateNum == 0) return false;
+    }
+
+    // 文件头与单词记录先占位，数据段写完后回填
+    QByteArray image(sizeof(DFAImageHeader) + names.size() * sizeof(DFAImageToken), '\0');
+    QVector<DFAImageToken> tokens(names.size());
+    for (int i = 0; i < names.size(); i++) {
+        const DFATable &table = tables[i];
+        DFAImageToken &token = tokens[i];
+        memset(&token, 0, sizeof(token));
+        QByteArray name = names[i].toUtf8();
+        token.tokenId = i;
+        token.nameOffset = appendSection(image, name);
+        token.nameSize = name.size();
+        token.stateNum = table.stateNum;
+        token.classNum = table.classNum;
+        token.startState = table.startState;
+        token.stateWidth = table.stateWidth;
+        token.classMapOffset = appendSection(image, table.classMap);
+        token.tableOffset = appendSection(image, table.table);
+        token.tableSize = table.table.size();
+        token.acceptOffset = appendSection(image, table.acceptBits);
+        token.acceptSize = table.acceptBits.size();
+        token.wideOffset = appendSection(image, table.wideClass);
+        token.wideSize = table.wideClass.size();
+    }
+    header.fileSize = image.size();
+    memcpy(image.data(), &header, sizeof(header));
+    if (!tokens.empty()) {
+        memcpy(image.data() + header.tokenOffset, tokens.constData(), tokens.size() * sizeof(DFAImageToken));
+    }
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(image);
+    return file.commit();
+}
+
+/*!
+    @name   load
+    @brief  内存映射并载入镜像
+    @param  fileName 文件名
+    @return 是否成功，失败原因见 error
+    @attention  校验文件头与各段边界，并扫描一遍表项是否越界，数组不做复制
+*/
+bool DFAImage::load(QString fileName) {
+    names.clear();
+    tables.clear();
+    error.clear();
+    if (file.isOpen()) file.close();    // 以本对象打开新文件时会解除之前的映射
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "镜像文件打开失败";
+        return false;
+    }
+    qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(DFAImageHeader))) {
+        error = "镜像文件过短";
+        return false;
+    }
+    const uchar *base = file.map(0, fileSize);
+    if (!base) {
+        error = "镜像文件映射失败";
+        return false;
+    }
+
+    const DFAImageHeader *header = reinterpret_cast<const DFAImageHeader *>(base);
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0 || header->version != IMAGE_VERSION) {
+        error = "镜像文件格式或版本不匹配";
+        return false;
+    }
+    if (header->byteOrder != IMAGE_BYTE_ORDER) {
+        error = "镜像文件字节序不匹配";
+        return false;
+    }
+    if (header->fileSize != fileSize
+            || header->tokenOffset + quint64(header->tokenNum) * sizeof(DFAImageToken) > quint64(fileSize)) {
+        error = "镜像文件已损坏";
+        return false;
+    }
+    utf8 = header->flags & 1;
+
+    // 检查某一段是否在文件内
+    auto inFile = [&](quint32 offset, quint64 size) {
+        return offset % IMAGE_ALIGN == 0 && offset + size <= quint64(fileSize);
+    };
+
+    const DFAImageToken *tokens = reinterpret_cast<const DFAImageToken *>(base + header->tokenOffset);
+    for (quint32 i = 0; i < header->tokenNum; i++) {
+        const DFAImageToken &token = tokens[i];
+        quint64 tableSize = quint64(token.stateNum) * token.classNum * token.stateWidth;
+        if ((token.stateWidth != 1 && token.stateWidth != 2 && token.stateWidth != 4)
+                || token.stateNum == 0 || token.startState >= token.stateNum
+                || !inFile(token.nameOffset, token.nameSize)
+                || !inFile(token.classMapOffset, 256 * sizeof(quint16))
+                || token.tableSize != tableSize || !inFile(token.tableOffset, tableSize)
+                || token.acceptSize < (token.stateNum / 32 + 1) * sizeof(quint32) || !inFile(token.acceptOffset, token.acceptSize)
+                || !inFile(token.wideOffset, token.wideSize)) {
+            error = "镜像文件已损坏";
+            names.clear();
+            tables.clear();
+            return false;
+        }
+
+        DFATable table;
+        table.stateNum = token.stateNum;
+        table.classNum = token.classNum;
+        table.startState = token.startState;
+        table.deadState = token.stateNum;
+        table.stateWidth = token.stateWidth;
+        table.classMap = QByteArray::fromRawData(reinterpret_cast<const char *>(base + token.classMapOffset), 256 * sizeof(quint16));
+        table.table = QByteArray::fromRawData(reinterpret_cast<const char *>(base + token.tableOffset), token.tableSize);
+        table.acceptBits = QByteArray::fromRawData(reinterpret_cast<const char *>(base + token.acceptOffset), token.acceptSize);
+        table.wideClass = QByteArray::fromRawData(reinterpret_cast<const char *>(base + token.wideOffset), token.wideSize);
+        if (!validTable(table)) {
+            error = "镜像文件已损坏";
+            names.clear();
+            tables.clear();
+            return false;
+        }
+
+        names.append(QString::fromUtf8(reinterpret_cast<const char *>(base + token.nameOffset), token.nameSize));
+        tables.append(table);
+    }
+    return true;
+}
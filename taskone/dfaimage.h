@@ -0,0 +1,89 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    dfaimage.h
+*  @brief   最小化DFA二进制镜像头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef DFAIMAGE_H
+#define DFAIMAGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QFile>
+
+#include "dfa.h"
+
+/*!
+    @name  DFAImageHeader
+    @brief 镜像文件头，位于文件开头，共 64 字节
+*/
+struct DFAImageHeader
+{
+    char magic[8];          // "SCNUDFA"
+    quint32 version;        // 格式版本号
+    quint32 byteOrder;      // 写入时为 0x01020304，用于检查字节序
+    quint32 flags;          // 第 0 位表示 UTF-8 字节自动机
+    quint32 tokenNum;       // 单词数量
+    quint32 tokenOffset;    // 单词记录数组的偏移
+    quint32 fileSize;       // 文件总长度
+    quint32 reserved[8];
+};
+
+/*!
+    @name  DFAImageToken
+    @brief 单个单词的记录，共 64 字节；各偏移均相对文件开头且按 64 字节对齐
+*/
+struct DFAImageToken
+{
+    quint32 tokenId;        // 单词编号，终态接受的单词
+    quint32 nameOffset;     // 单词名称（UTF-8）
+    quint32 nameSize;
+    quint32 stateNum;       // 状态数量
+    quint32 classNum;       // 字符类数量
+    quint32 startState;     // 始态
+    quint32 stateWidth;     // 每个状态编号占用的字节数
+    quint32 classMapOffset; // 字符类映射，256 个 quint16
+    quint32 tableOffset;    // 连续转移表
+    quint32 tableSize;
+    quint32 acceptOffset;   // 终态位图
+    quint32 acceptSize;
+    quint32 wideOffset;     // 非 Latin-1 字符的字符类映射
+    quint32 wideSize;
+    quint32 reserved[2];
+};
+
+/*!
+    @name  DFAImage
+    @brief 版本化、按 64 字节对齐的最小化 DFA 二进制镜像；载入时内存映射文件，
+           转移表等数组直接指向映射内存，不解析也不复制
+    @attention 由 load 得到的 tables 引用映射内存，使用期间 DFAImage 不能销毁或重新载入
+*/
+class DFAImage
+{
+public:
+    DFAImage();
+
+    static bool save(QString fileName, QStringList names, QVector<DFATable> tables, bool utf8);    // 写入镜像
+    bool load(QString fileName);        // 内存映射并载入镜像
+
+    QStringList names;                  // 单词名称，下标即单词编号
+    QVector<DFATable> tables;           // 与 names 对应的转移表
+    bool utf8;                          // 是否为 UTF-8 字节自动机
+    QString error;                      // 载入失败的原因
+
+private:
+    QFile file;                         // 被映射的文件
+};
+
+#endif // DFAIMAGE_H
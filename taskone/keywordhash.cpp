@@ -0,0 +1,182 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    keywordhash.cpp
+*  @brief   关键字最小完美哈希实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "keywordhash.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+static const quint32 MAX_SEED = 1 << 20;    // 每个桶尝试的种子数量上限
+
+KeywordHash::KeywordHash() {
+}
+
+/*!
+    @name   clear
+    @brief  清空
+    @param
+    @return
+    @attention
+*/
+void KeywordHash::clear() {
+    keys.clear();
+    disp.clear();
+}
+
+/*!
+    @name   hash
+    @brief  带种子的 FNV-1a 哈希
+    @param  word 单词
+    @param  seed 种子
+    @return 哈希值
+    @attention  生成代码中的 kw_hash 与此完全一致，修改时需同步
+*/
+quint32 KeywordHash::hash(const QByteArray &word, quint32 seed) {
+    quint32 h = 2166136261u ^ (seed * 16777619u);
+    for (int i = 0; i < word.size(); i++) {
+        h ^= (uchar)word[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*!
+    @name   hash
+    @brief  带种子的 FNV-1a 哈希
+    @param  word 单词
+    @param  len 长度
+    @param  seed 种子
+    @return 哈希值
+    @attention  每个字符视为一个字节，与 QByteArray 版本的结果相同
+*/
+quint32 KeywordHash::hash(const QChar *word, int len, quint32 seed) {
+    quint32 h = 2166136261u ^ (seed * 16777619u);
+    for (int i = 0; i < len; i++) {
+        h ^= (uchar)word[i].unicode();
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*!
+    @name   build
+    @brief  构造最小完美哈希
+    @param  keywords 关键字
+    @return 是否成功
+    @attention  桶按大小降序处理：多个关键字的桶搜索种子使其全部落入空槽，
+                只有一个关键字的桶直接记录剩余的空槽
+*/
+bool KeywordHash::build(QList<QByteArray> keywords) {
+    clear();
+    int n = keywords.size();
+    if (n == 0) return true;
+    if (keywords.toSet().size() != n) return false;
+
+    // 第一次哈希分桶
+    QVector<QList<QByteArray>> buckets(n);
+    for (QByteArray word: keywords) {
+        buckets[hash(word, 0) % n].append(word);
+    }
+    QVector<int> order(n);
+    for (int i = 0; i < n; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    QVector<QByteArray> slots(n);
+    QVector<bool> used(n, false);
+    disp = QVector<qint32>(n, 0);
+    int i = 0;
+    for (; i < n && buckets[order[i]].size() > 1; i++) {
+        const QList<QByteArray> &bucket = buckets[order[i]];
+        quint32 seed = 1;
+        QVector<int> pos;
+        for (; seed < MAX_SEED; seed++) {
+            pos.clear();
+            bool ok = true;
+            for (QByteArray word: bucket) {
+                int slot = hash(word, seed) % n;
+                if (used[slot] || pos.contains(slot)) {
+                    ok = false;
+                    break;
+                }
+                pos.append(slot);
+            }
+            if (ok) break;
+        }
+        if (seed == MAX_SEED) {
+            clear();
+            return false;
+        }
+        disp[order[i]] = seed;
+        for (int j = 0; j < bucket.size(); j++) {
+            used[pos[j]] = true;
+            slots[pos[j]] = bucket[j];
+        }
+    }
+
+    // 单个关键字的桶依次占用剩余空槽
+    int freeSlot = 0;
+    for (; i < n && buckets[order[i]].size() == 1; i++) {
+        while (used[freeSlot]) freeSlot++;
+        used[freeSlot] = true;
+        slots[freeSlot] = buckets[order[i]][0];
+        disp[order[i]] = -freeSlot - 1;
+    }
+
+    keys = slots.toList();
+    return true;
+}
+
+/*!
+    @name   contains
+    @brief  是否为关键字
+    @param  word 单词
+    @return
+    @attention  空桶的位移值为 0，此时按种子 0 取槽位，由最后的比较排除
+*/
+bool KeywordHash::contains(const QByteArray &word) const {
+    int n = keys.size();
+    if (n == 0) return false;
+    qint32 d = disp[hash(word, 0) % n];
+    int slot = d < 0 ? -d - 1 : hash(word, d) % n;
+    return keys[slot] == word;
+}
+
+/*!
+    @name   contains
+    @brief  是否为关键字
+    @param  word 单词起始位置
+    @param  len 单词长度
+    @return
+    @attention  含编码不小于 256 的字符时不是关键字
+*/
+bool KeywordHash::contains(const QChar *word, int len) const {
+    int n = keys.size();
+    if (n == 0) return false;
+    for (int i = 0; i < len; i++) {
+        if (word[i].unicode() >= 256) return false;
+    }
+    qint32 d = disp[hash(word, len, 0) % n];
+    int slot = d < 0 ? -d - 1 : hash(word, len, d) % n;
+    const QByteArray &key = keys[slot];
+    if (key.size() != len) return false;
+    for (int i = 0; i < len; i++) {
+        if ((uchar)key[i] != word[i].unicode()) return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    keywordhash.h
+*  @brief   关键字最小完美哈希头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef KEYWORDHASH_H
+#define KEYWORDHASH_H
+
+#include <QByteArray>
+#include <QChar>
+#include <QList>
+#include <QVector>
+
+/*!
+    @name  KeywordHash
+    @brief 关键字的最小完美哈希（哈希-位移法，CHD 的简化形式）：
+           第一次哈希确定桶，桶的位移值给出第二次哈希的种子或直接给出槽位，
+           n 个关键字恰好占满 n 个槽位，查询只需两次哈希与一次比较
+*/
+class KeywordHash
+{
+public:
+    KeywordHash();
+    void clear();                                   // 清空
+    bool build(QList<QByteArray> keywords);         // 构造，关键字重复或找不到位移值时返回 false
+    bool contains(const QByteArray &word) const;    // 是否为关键字
+    bool contains(const QChar *word, int len) const;    // 是否为关键字，直接在源程序上查询，不复制
+    bool empty() const { return keys.empty(); }
+
+    static quint32 hash(const QByteArray &word, quint32 seed);  // 带种子的 FNV-1a
+    static quint32 hash(const QChar *word, int len, quint32 seed);  // 同上，word 只含编码小于 256 的字符
+
+    QList<QByteArray> keys;     // 按槽位排列的关键字
+    QVector<qint32> disp;       // 每个桶的位移值：正数为第二次哈希的种子，负数 -d-1 为槽位
+};
+
+#endif // KEYWORDHASH_H
@@ -0,0 +1,772 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    lexer.cpp
+*  @brief   进程内词法分析器实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "lexer.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+static const int MAX_HASH_KEYWORD = 4096;   // 完美哈希的关键字数量上限
+static const int MAX_LITERAL_WORD = 4096;   // 单个字面量单词的字符串数量上限
+
+Lexer::Lexer(): linear(false) {
+    this->clear();
+}
+
+/*!
+    @name   clear
+    @brief  清空词法分析器
+    @param
+    @return
+    @attention
+*/
+void Lexer::clear() {
+    names.clear();
+    tables.clear();
+    utf8 = false;
+    keywords.clear();
+    isLiteral.clear();
+    modes.clear();
+    modeTokens.clear();
+    modeLiterals.clear();
+    switchTo.clear();
+    keywordModes.clear();
+}
+
+/*!
+    @name   build
+    @brief  载入各单词的最小化 DFA
+    @param  id2minidfa 单词名称到最小化 DFA 的映射
+    @param  utf8 DFA 是否为 UTF-8 字节自动机
+    @param  hashKeyword 是否尝试用完美哈希代替 keyword 的 DFA
+    @param  literalTrie 是否把字面量单词合并为一棵字典树
+    @return
+    @attention  与 toCode 生成的程序一致：keyword 最先尝试，长度相同时先尝试者优先；
+                每个模式只尝试属于该模式的单词
+*/
+void Lexer::build(QHash<QString, DFA> &id2minidfa, bool utf8, bool hashKeyword, bool literalTrie) {
+    clear();
+    this->utf8 = utf8;
+    if (hashKeyword) {
+        keywords.build(hashableKeywords(id2minidfa));
+    }
+    if (id2minidfa.contains("keyword") && keywords.empty()) {
+        names.append("keyword");
+    }
+    for (QString key: id2minidfa.keys()) {
+        if (key == "keyword") continue;
+        names.append(key);
+    }
+    for (QString name: names) {
+        tables.append(id2minidfa[name].table);
+    }
+    isLiteral = QVector<bool>(names.size(), false);
+
+    // 字面量单词不再逐个运行 DFA，放入所属模式的字典树，同一字面量归先尝试的单词
+    QVector<QStringList> literalLists(names.size());
+    if (literalTrie) {
+        for (int k = 0; k < names.size(); k++) {
+            isLiteral[k] = literalWords(id2minidfa[names[k]], literalLists[k]);
+        }
+    }
+
+    modes = modesOf(names, tokenModes);
+    modeTokens = QVector<QVector<int>>(modes.size());
+    modeLiterals = QVector<LiteralTrie>(modes.size());
+    for (int m = 0; m < modes.size(); m++) {
+        QList<QPair<QByteArray, int>> words;
+        for (int k = 0; k < names.size(); k++) {
+            if (!tokenModes.value(names[k], QStringList("INITIAL")).contains(modes[m])) continue;
+            if (!isLiteral[k]) {
+                modeTokens[m].append(k);
+                continue;
+            }
+            for (QString word: literalLists[k]) {
+                words.append(qMakePair(word.toLatin1(), k));
+            }
+        }
+        modeLiterals[m].build(words);
+    }
+    switchTo = QVector<int>(names.size(), -1);
+    for (int k = 0; k < names.size(); k++) {
+        if (nextMode.contains(names[k])) switchTo[k] = modes.indexOf(nextMode[names[k]]);
+    }
+    keywordModes = QVector<bool>(modes.size(), false);
+    if (!keywords.empty()) {
+        for (int m = 0; m < modes.size(); m++) {
+            keywordModes[m] = tokenModes.value("keyword", QStringList("INITIAL")).contains(modes[m]);
+        }
+    }
+}
+
+/*!
+    @name   build
+    @brief  载入镜像中的转移表
+    @param  image 已载入的 DFA 镜像
+    @return
+    @attention  转移表直接引用镜像的映射内存，不复制
+*/
+void Lexer::build(const DFAImage &image) {
+    clear();
+    utf8 = image.utf8;
+    names = image.names;
+    tables = image.tables;
+    isLiteral = QVector<bool>(names.size(), false);
+
+    // 镜像不保存模式，全部单词属于 INITIAL
+    modes = QStringList("INITIAL");
+    modeTokens = QVector<QVector<int>>(1);
+    for (int k = 0; k < names.size(); k++) {
+        modeTokens[0].append(k);
+    }
+    modeLiterals = QVector<LiteralTrie>(1);
+    switchTo = QVector<int>(names.size(), -1);
+    keywordModes = QVector<bool>(1, false);
+}
+
+static const qint64 MAX_BITMAP_WORDS = qint64(1) << 24;    // 位图至多 64 MiB
+
+FailedSet::FailedSet(qint64 size) : size(size) {}
+
+/*!
+    @name   contains
+    @brief  组合是否已失败
+    @param  bit 位置 * stateNum + 状态
+    @return
+    @attention  尚未记录过任何组合时不分配
+*/
+bool FailedSet::contains(qint64 bit) const {
+    if (size / 32 + 1 > MAX_BITMAP_WORDS) return large.contains(bit);
+    return !bitmap.isEmpty() && ((bitmap[int(bit >> 5)] >> (bit & 31)) & 1);
+}
+
+/*!
+    @name   insert
+    @brief  记录失败的组合
+    @param  bit 位置 * stateNum + 状态
+    @return
+    @attention  位图在第一次记录时分配，超过 MAX_BITMAP_WORDS 个字时改用哈希集合，
+                字数不会超出 QVector 的 int 下标范围
+*/
+void FailedSet::insert(qint64 bit) {
+    qint64 words = size / 32 + 1;
+    if (words > MAX_BITMAP_WORDS) {
+        large.insert(bit);
+        return;
+    }
+    if (bitmap.isEmpty()) bitmap = QVector<quint32>(int(words), 0);
+    bitmap[int(bit >> 5)] |= 1u << (bit & 31);
+}
+
+/*!
+    @name   match
+    @brief  第 k 个单词从 pos 开始的最长匹配长度
+    @param  k 单词下标
+    @param  src 源程序
+    @param  pos 开始位置
+    @param  visits 不为空时累加每个状态的访问次数
+    @param  failed 不为空时为该单词失败的（状态, 位置）组合，编号为 位置 * stateNum + 状态
+    @return 最长匹配长度，无法匹配时返回 -1
+    @attention  最后一个终态之后经过的（状态, 位置）不可能再到达终态，记入 failed；
+                以后从其他位置开始的匹配到达这些组合时立即停止（Reps 的表格化最长匹配），
+                每个组合至多在失败段中被经过一次，整个分词过程是线性时间
+*/
+int Lexer::match(int k, const QString &src, int pos, QVector<qint64> *visits, FailedSet *failed) const {
+    const DFATable &table = tables[k];
+    int state = table.startState;
+    int matchLen = table.isAccept(state) ? 0 : -1;
+    if (visits) (*visits)[state]++;
+    QVector<qint64> trail;      // 最后一个终态之后经过的组合
+    for (int i = pos; i < src.size(); i++) {
+        state = table.next(state, table.charClass(src[i]));
+        if (state == table.deadState) break;
+        if (failed) {
+            qint64 bit = qint64(i + 1) * table.stateNum + state;
+            if (failed->contains(bit)) break;
+            trail.append(bit);
+        }
+        if (visits) (*visits)[state]++;
+        if (table.isAccept(state)) {
+            matchLen = i - pos + 1;
+            trail.clear();
+        }
+    }
+    for (qint64 bit: trail) {
+        failed->insert(bit);
+    }
+    return matchLen;
+}
+
+/*!
+    @name   isLatin1
+    @brief  字符串是否只含编码小于 256 的字符
+    @param  word
+    @return
+    @attention  关键字按字节存储，含其他字符的单词不可能是关键字
+*/
+static bool isLatin1(const QString &word) {
+    for (QChar c: word) {
+        if (c.unicode() >= 256) return false;
+    }
+    return true;
+}
+
+/*!
+    @name   machineString
+    @brief  DFA 实际运行的字符串
+    @param  src 源程序
+    @return UTF-8 模式下每个字节以编码相同的 Latin-1 字符表示，否则为 src 本身
+    @attention  scan 返回的区间是该字符串上的位置
+*/
+QString Lexer::machineString(const QString &src) const {
+    return utf8 ? QString::fromLatin1(src.toUtf8()) : src;
+}
+
+/*!
+    @name   kindName
+    @brief  单词类型的名称
+    @param  kind TokenSpan 的 kind
+    @return
+    @attention
+*/
+QString Lexer::kindName(int kind) const {
+    return kind == names.size() ? QString("keyword") : names[kind];
+}
+
+/*!
+    @name   scanWith
+    @brief  分词，每识别出一个单词调用一次 emit
+    @param  src machineString 转换后的源程序
+    @param  visits 不为空时按 names 顺序累加各单词 DFA 的状态访问次数
+    @param  emit 接收单词区间，返回 false 时停止分词
+    @return
+    @attention  遇到无法识别的字符时抛出 QString 异常；
+                匹配、关键字分类都直接在 src 上进行，每个单词只记录区间，不复制文本
+*/
+template <typename Emit>
+void Lexer::scanWith(const QString &src, QVector<QVector<qint64>> *visits, Emit emit) const {
+    // 线性时间模式：每个单词 stateNum * (n + 1) 个（状态, 位置）组合，第一次失败时才分配
+    QVector<FailedSet> failed;
+    if (linear) {
+        for (int k = 0; k < names.size(); k++) {
+            failed.append(FailedSet(isLiteral[k] ? 0 : qint64(tables[k].stateNum) * (src.size() + 1)));
+        }
+    }
+
+    int pos = 0;
+    int mode = 0;
+    while (true) {
+        // 跳过空白字符，UTF-8 模式下只有 ASCII 空白，避免把续字节 0x85、0xA0 当作空白；
+        // 其他模式（如字符串、注释内部）的空白也由该模式的单词识别
+        while (mode == 0 && pos < src.size() && src[pos].isSpace() && (!utf8 || src[pos].unicode() < 0x80)) pos++;
+        if (pos >= src.size()) break;
+
+        // 最长匹配，长度相同时先尝试者优先：keyword 的 DFA 最先，其次是字面量字典树，最后是其余单词
+        int bestLen = 0, best = -1;
+        auto tryToken = [&](int k) {
+            int matchLen = match(k, src, pos, visits ? &(*visits)[k] : nullptr, linear ? &failed[k] : nullptr);
+            if (matchLen > bestLen) {
+                bestLen = matchLen;
+                best = k;
+            }
+        };
+        const QVector<int> &order = modeTokens[mode];
+        int i = 0;
+        if (i < order.size() && names[order[i]] == "keyword") tryToken(order[i++]);
+        if (!modeLiterals[mode].empty()) {
+            int tokenId = -1;
+            int matchLen = modeLiterals[mode].match(src, pos, &tokenId);
+            if (matchLen > bestLen) {
+                bestLen = matchLen;
+                best = tokenId;
+            }
+        }
+        for (; i < order.size(); i++) {
+            tryToken(order[i]);
+        }
+        if (best == -1) throw unknownWord(src, pos, mode);
+
+        TokenSpan span = {best, pos, bestLen};
+        if (keywordModes[mode] && keywords.contains(src.constData() + pos, bestLen)) {
+            span.kind = names.size();
+        }
+        if (!emit(span)) return;
+        pos += bestLen;
+        if (switchTo[best] != -1) mode = switchTo[best];
+    }
+}
+
+/*!
+    @name   scan
+    @brief  分词，返回单词区间
+    @param  src machineString 转换后的源程序
+    @param  visits 不为空时按 names 顺序累加各单词 DFA 的状态访问次数
+    @return 单词区间列表
+    @attention  遇到无法识别的字符时抛出 QString 异常
+*/
+QVector<TokenSpan> Lexer::scan(const QString &src, QVector<QVector<qint64>> *visits) const {
+    QVector<TokenSpan> spans;
+    spans.reserve(src.size() / 4 + 1);
+    scanWith(src, visits, [&](const TokenSpan &span) {
+        spans.append(span);
+        return true;
+    });
+    return spans;
+}
+
+/*!
+    @name   stream
+    @brief  分词，单词边识别边写入队列
+    @param  src 源程序
+    @param  queue 单词队列，本函数是它唯一的生产者
+    @return
+    @attention  在工作线程中运行：队列满时等待消费者，消费者取消后停止；
+                结束时关闭队列，无法识别的字符作为错误信息随队列一起交给消费者；
+                单词与载入单词编码文件时的约定相同：number、identifier、annotation 为（单词, 类型），
+                其余为（单词, 单词），文法中的终结符即单词本身
+*/
+void Lexer::stream(QString src, TokenQueue *queue) const {
+    src = machineString(src);
+    const QSet<QString> valueKinds({"number", "identifier", "annotation"});
+    try {
+        scanWith(src, nullptr, [&](const TokenSpan &span) {
+            QString word = src.mid(span.offset, span.length);
+            if (utf8) word = QString::fromUtf8(word.toLatin1());
+            QString kind = kindName(span.kind);
+            return queue->push(qMakePair(word, valueKinds.contains(kind) ? kind : word));
+        });
+    } catch (QString e) {
+        queue->close(e);
+        return;
+    }
+    queue->close();
+}
+
+/*!
+    @name   unknownWord
+    @brief  无法识别的单词的错误信息
+    @param  src machineString 转换后的源程序
+    @param  pos 出错位置
+    @param  mode 当前模式
+    @return
+    @attention  UTF-8 模式下取出完整的一个字符
+*/
+QString Lexer::unknownWord(const QString &src, int pos, int mode) const {
+    return QString("无法识别的单词：") + (utf8 ? QString::fromUtf8(src.mid(pos, 4).toLatin1()).left(1) : src.mid(pos, 1))
+            + (mode == 0 ? "" : "（模式 " + modes[mode] + "）");
+}
+
+/*!
+    @name   scanBatch
+    @brief  多个源程序交错分词
+    @param  srcs machineString 转换后的源程序
+    @param  errors 写入各源程序的错误信息，成功时为空
+    @return 各源程序的单词区间，出错的源程序只保留出错位置之前的单词
+    @attention  每 MAX_LANES 个源程序一组，每一轮为组内每个源程序识别一个单词：
+                同一单词的 DFA 用 matchLanes 在各源程序上同步运行，查表的访存延迟相互重叠；
+                尝试顺序与 scan 相同，结果也相同；线性时间模式的失败位图按单个源程序记录，此时逐个调用 scan
+*/
+QVector<QVector<TokenSpan>> Lexer::scanBatch(const QVector<QString> &srcs, QStringList &errors) const {
+    QVector<QVector<TokenSpan>> result(srcs.size());
+    errors = QStringList();
+    for (int i = 0; i < srcs.size(); i++) errors.append(QString());
+    if (linear) {
+        for (int i = 0; i < srcs.size(); i++) {
+            try {
+                result[i] = scan(srcs[i]);
+            } catch (QString e) {
+                errors[i] = e;
+            }
+        }
+        return result;
+    }
+
+    // 每个模式尝试的 DFA 单词
+    QVector<QVector<bool>> modeHas(modes.size(), QVector<bool>(names.size(), false));
+    for (int m = 0; m < modes.size(); m++) {
+        for (int k: modeTokens[m]) modeHas[m][k] = true;
+    }
+    int first = (!names.empty() && names[0] == "keyword") ? 1 : 0;     // keyword 在字典树之前尝试
+
+    const int LANES = DFATable::MAX_LANES;
+    for (int base = 0; base < srcs.size(); base += LANES) {
+        int n = qMin(LANES, srcs.size() - base);
+        int pos[LANES], mode[LANES], bestLen[LANES], best[LANES];
+        bool done[LANES];
+        for (int l = 0; l < n; l++) {
+            pos[l] = 0;
+            mode[l] = 0;
+            done[l] = false;
+        }
+        while (true) {
+            int active[LANES], activeNum = 0;
+            for (int l = 0; l < n; l++) {
+                if (done[l]) continue;
+                const QString &src = srcs[base + l];
+                while (mode[l] == 0 && pos[l] < src.size() && src[pos[l]].isSpace()
+                       && (!utf8 || src[pos[l]].unicode() < 0x80)) pos[l]++;
+                if (pos[l] >= src.size()) {
+                    done[l] = true;
+                    continue;
+                }
+                active[activeNum++] = l;
+                bestLen[l] = 0;
+                best[l] = -1;
+            }
+            if (activeNum == 0) break;
+
+            // 第 k 个单词在当前模式包含它的源程序上同步运行
+            auto tryToken = [&](int k) {
+                const QChar *text[LANES];
+                int length[LANES], lane[LANES], matchLen[LANES], cnt = 0;
+                for (int i = 0; i < activeNum; i++) {
+                    int l = active[i];
+                    if (!modeHas[mode[l]][k]) continue;
+                    const QString &src = srcs[base + l];
+                    text[cnt] = src.constData() + pos[l];
+                    length[cnt] = src.size() - pos[l];
+                    lane[cnt++] = l;
+                }
+                if (cnt == 0) return;
+                tables[k].matchLanes(text, length, cnt, matchLen);
+                for (int i = 0; i < cnt; i++) {
+                    if (matchLen[i] > bestLen[lane[i]]) {
+                        bestLen[lane[i]] = matchLen[i];
+                        best[lane[i]] = k;
+                    }
+                }
+            };
+            if (first) tryToken(0);
+            for (int i = 0; i < activeNum; i++) {
+                int l = active[i];
+                if (modeLiterals[mode[l]].empty()) continue;
+                int tokenId = -1;
+                int matchLen = modeLiterals[mode[l]].match(srcs[base + l], pos[l], &tokenId);
+                if (matchLen > bestLen[l]) {
+                    bestLen[l] = matchLen;
+                    best[l] = tokenId;
+                }
+            }
+            for (int k = first; k < names.size(); k++) {
+                tryToken(k);
+            }
+
+            for (int i = 0; i < activeNum; i++) {
+                int l = active[i];
+                const QString &src = srcs[base + l];
+                if (best[l] == -1) {
+                    errors[base + l] = unknownWord(src, pos[l], mode[l]);
+                    done[l] = true;
+                    continue;
+                }
+                TokenSpan span = {best[l], pos[l], bestLen[l]};
+                if (keywordModes[mode[l]] && keywords.contains(src.constData() + pos[l], bestLen[l])) {
+                    span.kind = names.size();
+                }
+                result[base + l].append(span);
+                pos[l] += bestLen[l];
+                if (switchTo[best[l]] != -1) mode[l] = switchTo[best[l]];
+            }
+        }
+    }
+    return result;
+}
+
+/*!
+    @name   lex
+    @brief  分词
+    @param  src 源程序
+    @param  visits 不为空时按 names 顺序累加各单词 DFA 的状态访问次数
+    @return （单词, 类型）列表
+    @attention  遇到无法识别的字符时抛出 QString 异常；
+                UTF-8 模式下 DFA 直接运行在字节上，每个字节以编码相同的 Latin-1 字符表示，不做解码；
+                只在最后按区间取出单词文本，需要零拷贝时直接使用 scan
+*/
+QList<QPair<QString, QString>> Lexer::lex(QString src, QVector<QVector<qint64>> *visits) const {
+    src = machineString(src);
+    QVector<TokenSpan> spans = scan(src, visits);
+    QList<QPair<QString, QString>> tokens;
+    tokens.reserve(spans.size());
+    for (const TokenSpan &span: spans) {
+        QString word = src.mid(span.offset, span.length);
+        if (utf8) word = QString::fromUtf8(word.toLatin1());
+        tokens.append(qMakePair(word, kindName(span.kind)));
+    }
+    return tokens;
+}
+
+/*!
+    @name   profile
+    @brief  在样例上分词，统计各单词 DFA 的状态访问次数
+    @param  src 样例源程序
+    @param  error 写入分词失败的原因，成功时清空
+    @return 单词名称到状态访问次数的映射
+    @attention  遇到无法识别的字符时停止统计，已统计的结果仍然有效
+*/
+QHash<QString, QVector<qint64>> Lexer::profile(QString src, QString *error) const {
+    QVector<QVector<qint64>> visits;
+    for (int k = 0; k < names.size(); k++) {
+        visits.append(QVector<qint64>(tables[k].stateNum, 0));
+    }
+    error->clear();
+    try {
+        lex(src, &visits);
+    } catch (QString e) {
+        *error = e;
+    }
+
+    QHash<QString, QVector<qint64>> result;
+    for (int k = 0; k < names.size(); k++) {
+        result[names[k]] = visits[k];
+    }
+    return result;
+}
+
+/*!
+    @name   readSource
+    @brief  读取源文件
+    @param  fileName 源文件，按 UTF-8 读取
+    @param  src 写入文件内容
+    @return 是否成功
+    @attention
+*/
+bool Lexer::readSource(QString fileName, QString &src) {
+    QFile srcFile(fileName);
+    if (!srcFile.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QTextStream in(&srcFile);
+    in.setCodec("UTF-8");
+    src = in.readAll();
+    srcFile.close();
+    return true;
+}
+
+/*!
+    @name   writeTokens
+    @brief  单词流写入 fileName.lex
+    @param  fileName 源文件
+    @param  src machineString 转换后的源程序
+    @param  spans 单词区间
+    @return 错误信息，成功时为空
+    @attention  每行为“类型\t单词”，单词经 escapeWord 转义
+*/
+QString Lexer::writeTokens(QString fileName, const QString &src, const QVector<TokenSpan> &spans) const {
+    QFile lexFile(fileName + ".lex");
+    if (!lexFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+        return fileName + ".lex：无法写入";
+    }
+    QTextStream out(&lexFile);
+    out.setCodec("UTF-8");
+    for (const TokenSpan &span: spans) {
+        QString word = src.mid(span.offset, span.length);
+        if (utf8) word = QString::fromUtf8(word.toLatin1());
+        out << kindName(span.kind) << '\t' << escapeWord(word) << '\n';
+    }
+    out << flush;
+    lexFile.close();
+    return QString();
+}
+
+/*!
+    @name   lexFile
+    @brief  对文件分词
+    @param  fileName 源文件，按 UTF-8 读取
+    @return 错误信息，成功时为空
+    @attention  单词流写入 fileName.lex，遇到无法识别的字符时不写出；
+                只读取词法分析器的成员，多个线程可以同时对不同文件分词
+*/
+QString Lexer::lexFile(QString fileName) const {
+    QString src;
+    if (!readSource(fileName, src)) return fileName + "：无法读取";
+    src = machineString(src);
+    QVector<TokenSpan> spans;
+    try {
+        spans = scan(src);
+    } catch (QString e) {
+        return fileName + "：" + e;
+    }
+    return writeTokens(fileName, src, spans);
+}
+
+/*!
+    @name   lexFileGroup
+    @brief  对一组文件交错分词
+    @param  fileNames 源文件列表
+    @return 出错文件的错误信息
+    @attention  与逐个调用 lexFile 的结果相同
+*/
+QStringList Lexer::lexFileGroup(QStringList fileNames) const {
+    QStringList errors;
+    QStringList readable;
+    QVector<QString> srcs;
+    for (QString fileName: fileNames) {
+        QString src;
+        if (!readSource(fileName, src)) {
+            errors.append(fileName + "：无法读取");
+            continue;
+        }
+        readable.append(fileName);
+        srcs.append(machineString(src));
+    }
+    QStringList scanErrors;
+    QVector<QVector<TokenSpan>> spans = scanBatch(srcs, scanErrors);
+    for (int i = 0; i < srcs.size(); i++) {
+        QString error = scanErrors[i].isEmpty() ? writeTokens(readable[i], srcs[i], spans[i]) : readable[i] + "：" + scanErrors[i];
+        if (!error.isEmpty()) errors.append(error);
+    }
+    return errors;
+}
+
+/*!
+    @name  FileLexer
+    @brief 供 QtConcurrent::mapped 调用的 lexFileGroup，每个任务为一组文件
+*/
+class FileLexer
+{
+public:
+    typedef QStringList result_type;
+
+    FileLexer(const Lexer *lexer, bool interleave): lexer(lexer), interleave(interleave) {}
+    QStringList operator()(const QStringList &fileNames) const {
+        if (interleave) return lexer->lexFileGroup(fileNames);
+        QStringList errors;
+        for (QString fileName: fileNames) {
+            QString error = lexer->lexFile(fileName);
+            if (!error.isEmpty()) errors.append(error);
+        }
+        return errors;
+    }
+
+    const Lexer *lexer;
+    bool interleave;
+};
+
+/*!
+    @name   lexFiles
+    @brief  在线程池中批量分词
+    @param  fileNames 源文件列表
+    @param  interleave 是否每 MAX_LANES 个文件交错分词
+    @return 立即返回，每组文件一个结果，为该组出错文件的错误信息
+    @attention  转移表、字典树等只读共享，每个文件的分词状态（位置、模式、失败位图）都是局部变量，
+                工作线程之间没有共享的可写数据，吞吐量随线程数线性增长；
+                不等待分词结束，完成之前词法分析器不能修改或销毁
+*/
+QFuture<QStringList> Lexer::lexFiles(QStringList fileNames, bool interleave) const {
+    QList<QStringList> groups;
+    int size = interleave ? DFATable::MAX_LANES : 1;
+    for (int i = 0; i < fileNames.size(); i += size) {
+        groups.append(fileNames.mid(i, size));
+    }
+    return QtConcurrent::mapped(groups, FileLexer(this, interleave));
+}
+
+/*!
+    @name   escapeWord
+    @brief  转义单词中的反斜杠、制表符与换行
+    @param  word 单词
+    @return 转义后的单词
+    @attention  与生成的批量分词程序的 write_escaped 一致
+*/
+QString Lexer::escapeWord(QString word) {
+    QString result = "";
+    for (QChar c: word) {
+        if (c == '\\') result += "\\\\";
+        else if (c == '\t') result += "\\t";
+        else if (c == '\n') result += "\\n";
+        else if (c == '\r') result += "\\r";
+        else result += c;
+    }
+    return result;
+}
+
+/*!
+    @name   hashableKeywords
+    @brief  可以改用完美哈希识别的关键字
+    @param  id2minidfa 单词名称到最小化 DFA 的映射
+    @return 关键字列表，不满足条件时为空
+    @attention  keyword 的语言有限、只含编码小于 256 的字符，且被某个其他单词（通常是标识符）的语言包含时，
+                其他单词的最长匹配结果恰好是关键字当且仅当原来 keyword 会胜出，分类结果不变
+*/
+QList<QByteArray> Lexer::hashableKeywords(QHash<QString, DFA> &id2minidfa) {
+    QList<QByteArray> result;
+    if (!id2minidfa.contains("keyword")) return result;
+    DFA &keyword = id2minidfa["keyword"];
+
+    QStringList words;
+    if (!keyword.words(words, MAX_HASH_KEYWORD) || words.empty()) return result;
+    for (QString word: words) {
+        if (!isLatin1(word)) return result;
+    }
+
+    // 关键字集合被某个单词包含：keyword - 该单词 为空
+    bool covered = false;
+    for (QString key: id2minidfa.keys()) {
+        if (key == "keyword") continue;
+        DFA diff;
+        diff.fromProduct(keyword, id2minidfa[key], '-');
+        if (diff.endStates.empty()) {
+            covered = true;
+            break;
+        }
+    }
+    if (!covered) return result;
+
+    for (QString word: words) {
+        result.append(word.toLatin1());
+    }
+    return result;
+}
+
+/*!
+    @name   literalWords
+    @brief  单词是否为字面量（运算符、界符等有限个字符串）
+    @param  minidfa 单词的最小化 DFA
+    @param  words 字面量列表
+    @return 语言有限、不超过上限且只含编码小于 256 的字符时返回 true
+    @attention
+*/
+bool Lexer::literalWords(const DFA &minidfa, QStringList &words) {
+    if (!minidfa.words(words, MAX_LITERAL_WORD)) return false;
+    for (QString word: words) {
+        if (!isLatin1(word)) {
+            words.clear();
+            return false;
+        }
+    }
+    return !words.empty();
+}
+
+/*!
+    @name   modesOf
+    @brief  全部模式
+    @param  names 单词名称
+    @param  tokenModes 单词所属的模式
+    @return 模式名称，INITIAL 在最前，其余按名称排序
+    @attention
+*/
+QStringList Lexer::modesOf(QStringList names, QHash<QString, QStringList> &tokenModes) {
+    QStringList result;
+    for (QString name: names) {
+        result += tokenModes.value(name, QStringList("INITIAL"));
+    }
+    result.removeDuplicates();
+    result.removeOne("INITIAL");
+    std::sort(result.begin(), result.end());
+    result.prepend("INITIAL");
+    return result;
+}
@@ -0,0 +1,116 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    lexer.h
+*  @brief   进程内词法分析器头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QHash>
+#include <QSet>
+#include <QFuture>
+
+#include "dfa.h"
+#include "dfaimage.h"
+#include "keywordhash.h"
+#include "literaltrie.h"
+#include "tokenqueue.h"
+
+/*!
+    @name  TokenSpan
+    @brief 单词在源程序中的区间，不复制单词文本
+*/
+struct TokenSpan
+{
+    int kind;       // 单词类型，names 的下标；names.size() 表示由完美哈希识别的 keyword
+    int offset;     // 起始位置
+    int length;     // 长度
+};
+
+/*!
+    @name  FailedSet
+    @brief 一个单词失败的（状态, 位置）组合，第一次记录时才分配；位图过大时改用哈希集合
+*/
+struct FailedSet
+{
+    explicit FailedSet(qint64 size = 0);
+    bool contains(qint64 bit) const;    // 组合是否已失败
+    void insert(qint64 bit);            // 记录失败的组合
+
+    qint64 size;                // 组合总数 stateNum * (n + 1)
+    QVector<quint32> bitmap;    // 位图，每个组合一位
+    QSet<qint64> large;         // 位图超过 MAX_BITMAP_WORDS 时使用
+};
+
+/*!
+    @name  Lexer
+    @brief 进程内词法分析器：直接在最小化 DFA 的连续转移表上分词，无需生成并编译代码
+*/
+class Lexer
+{
+public:
+    Lexer();
+    void clear();                                   // 清空词法分析器
+    void build(QHash<QString, DFA> &id2minidfa, bool utf8 = false,
+               bool hashKeyword = false, bool literalTrie = false);     // 载入各单词的最小化 DFA
+    void build(const DFAImage &image);              // 载入镜像中的转移表，镜像须比词法分析器存活更久
+
+    int match(int k, const QString &src, int pos, QVector<qint64> *visits = nullptr,
+              FailedSet *failed = nullptr) const;    // 第 k 个单词从 pos 开始的最长匹配长度
+    QVector<TokenSpan> scan(const QString &src, QVector<QVector<qint64>> *visits = nullptr) const;  // 分词，返回单词区间，src 须已按 machineString 转换
+    QVector<QVector<TokenSpan>> scanBatch(const QVector<QString> &srcs, QStringList &errors) const;   // 多个源程序交错分词，errors 为各源程序的错误信息
+    QList<QPair<QString, QString>> lex(QString src, QVector<QVector<qint64>> *visits = nullptr) const;  // 分词，返回（单词, 类型）列表
+    void stream(QString src, TokenQueue *queue) const;  // 分词，单词边识别边写入队列，供另一个线程同时读取
+    QString machineString(const QString &src) const;    // DFA 实际运行的字符串，UTF-8 模式下每个字节为一个字符
+    QString kindName(int kind) const;                   // 单词类型的名称
+    QHash<QString, QVector<qint64>> profile(QString src, QString *error) const;    // 在样例上分词，统计各单词 DFA 的状态访问次数
+    QString lexFile(QString fileName) const;                        // 对文件分词，单词流写入 fileName.lex，返回错误信息
+    QStringList lexFileGroup(QStringList fileNames) const;          // 对一组文件交错分词，返回出错文件的错误信息
+    QFuture<QStringList> lexFiles(QStringList fileNames, bool interleave = false) const;  // 在线程池中批量分词，不等待结束，各组出错文件的错误信息由 QFuture 给出
+    QString unknownWord(const QString &src, int pos, int mode) const;   // 无法识别的单词的错误信息
+    QString writeTokens(QString fileName, const QString &src, const QVector<TokenSpan> &spans) const;  // 单词流写入 fileName.lex
+
+    static QList<QByteArray> hashableKeywords(QHash<QString, DFA> &id2minidfa);  // 可以改用完美哈希识别的关键字
+    static bool literalWords(const DFA &minidfa, QStringList &words);          // 单词是否为字面量
+    static QStringList modesOf(QStringList names, QHash<QString, QStringList> &tokenModes);   // 全部模式，INITIAL 在最前
+    static bool readSource(QString fileName, QString &src);    // 按 UTF-8 读取源文件
+    static QString escapeWord(QString word);        // 转义单词中的反斜杠、制表符与换行，使单词流每行一个单词
+
+    QStringList names;                  // 单词名称，按尝试顺序排列
+    QVector<DFATable> tables;           // 与 names 对应的转移表
+    bool utf8;                          // DFA 是否为 UTF-8 字节自动机
+    KeywordHash keywords;               // 不为空时 keyword 不参与匹配，由完美哈希对匹配结果重新分类
+    QVector<bool> isLiteral;            // 与 names 对应，是否由字典树匹配
+    bool linear;                        // 记录失败的（状态, 位置）保证线性时间，属于匹配策略，clear 不重置
+
+    // 词法模式（flex 的排他开始条件），tokenModes 与 nextMode 为配置，clear 不重置
+    QHash<QString, QStringList> tokenModes; // 单词所属的模式，未列出的单词属于 INITIAL
+    QHash<QString, QString> nextMode;       // 识别出该单词后切换到的模式
+    QStringList modes;                      // 模式名称，0 号为 INITIAL
+    QVector<QVector<int>> modeTokens;       // 每个模式依次尝试的 DFA 单词（names 的下标）
+    QVector<LiteralTrie> modeLiterals;      // 每个模式的字面量字典树，单词编号为 names 的下标
+    QVector<int> switchTo;                  // 与 names 对应，识别后切换到的模式，-1 表示不切换
+    QVector<bool> keywordModes;             // 每个模式是否用完美哈希重新分类 keyword
+
+private:
+    template <typename Emit>
+    void scanWith(const QString &src, QVector<QVector<qint64>> *visits, Emit emit) const;  // 分词，每个单词区间交给 emit
+};
+
+#endif // LEXER_H
@@ -0,0 +1,135 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    lexercache.cpp
+*  @brief   已编译词法分析程序缓存实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "lexercache.h"
+
+#include <QCryptographicHash>
+#include <QTextStream>
+#include <QFileInfo>
+#include <QProcess>
+#include <QFile>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDateTime>
+
+static const quint32 CACHE_VERSION = 2;     // 代码生成方式改变时增加，旧缓存自动失效
+
+QString LexerCache::cacheDir;
+QString LexerCache::compiler = "g++";
+QStringList LexerCache::flags = QStringList() << "-O2";
+int LexerCache::maxEntries = 32;
+
+/*!
+    @name   directory
+    @brief  实际使用的缓存目录
+    @param
+    @return cacheDir 不为空时为 cacheDir，否则为 QStandardPaths::CacheLocation 下的 lexer_cache
+    @attention  系统缓存目录依赖应用名称，须在 QApplication 构造之后调用
+*/
+QString LexerCache::directory() {
+    if (!cacheDir.isEmpty()) return cacheDir;
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("lexer_cache");
+}
+
+/*!
+    @name   keyOf
+    @brief  单词定义与生成选项对应的缓存键
+    @param  spec 单词定义与影响生成代码的选项
+    @return SHA-256 十六进制串
+    @attention  编译器与编译参数参与哈希，修改参数后不会取到旧的程序；
+                不对生成代码取哈希：状态编号、函数顺序随 QHash 的随机种子变化，重启后代码文本不同
+*/
+QString LexerCache::keyOf(QString spec) {
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray::number(CACHE_VERSION));
+    hash.addData(compiler.toUtf8());
+    for (QString flag: flags) {
+        hash.addData(QByteArray(1, '\0'));
+        hash.addData(flag.toUtf8());
+    }
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(spec.toUtf8());
+    return QString(hash.result().toHex());
+}
+
+/*!
+    @name   executable
+    @brief  取得生成代码编译出的可执行文件
+    @param  spec 单词定义与影响生成代码的选项，作为缓存键
+    @param  code 由 spec 生成的词法分析程序，未命中时编译
+    @param  sourceFileName 未命中时保存源程序的文件名
+    @param  error 失败时写入错误信息
+    @return 可执行文件路径，失败时返回空串
+    @attention  先编译到临时文件，成功后再改名，编译中断不会留下不完整的缓存；
+                命中时更新修改时间，新增后按 maxEntries 清理，因此淘汰的是最久未使用的程序
+*/
+QString LexerCache::executable(QString spec, QString code, QString sourceFileName, QString *error) {
+    QString fileName = QDir(directory()).filePath(keyOf(spec));
+#ifdef Q_OS_WIN
+    fileName += ".exe";
+#endif
+    if (QFileInfo(fileName).isExecutable()) {
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        }
+        return fileName;
+    }
+
+    QFile source(sourceFileName);
+    if (!source.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        *error = "词法分析程序保存失败！";
+        return QString();
+    }
+    QTextStream out(&source);
+    out << code;
+    out << flush;
+    source.close();
+
+    QDir().mkpath(directory());
+    QString tempName = fileName + ".tmp";
+    QProcess process;
+    process.start(compiler, QStringList() << flags << sourceFileName << "-o" << tempName);
+    if (!process.waitForFinished() || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        *error = "编译失败!\n" + QString::fromLocal8Bit(process.readAllStandardError());
+        QFile::remove(tempName);
+        return QString();
+    }
+    QFile::remove(fileName);
+    if (!QFile::rename(tempName, fileName)) {
+        *error = "编译结果保存失败！";
+        return QString();
+    }
+    prune();
+    return fileName;
+}
+
+/*!
+    @name   prune
+    @brief  删除超出 maxEntries 的最旧可执行文件
+    @param
+    @return
+    @attention  按修改时间（最近使用时间）从新到旧保留，刚编译出的文件总是保留；正在编译的 .tmp 文件不参与计数
+*/
+void LexerCache::prune() {
+    QFileInfoList entries;
+    for (QFileInfo entry: QDir(directory()).entryInfoList(QDir::Files, QDir::Time)) {
+        if (entry.suffix() != "tmp") entries.append(entry);
+    }
+    for (int i = maxEntries; i < entries.size(); i++) {
+        QFile::remove(entries[i].filePath());
+    }
+}
@@ -0,0 +1,42 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    lexercache.h
+*  @brief   已编译词法分析程序缓存头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef LEXERCACHE_H
+#define LEXERCACHE_H
+
+#include <QString>
+#include <QStringList>
+
+/*!
+    @name  LexerCache
+    @brief 以单词定义、生成选项与编译参数的哈希为键，在磁盘上缓存编译好的词法分析程序，
+           单词定义不变时重新分词不必再次编译；可执行文件数超过 maxEntries 时删除最久未使用的
+*/
+class LexerCache
+{
+public:
+    static QString cacheDir;        // 缓存目录，为空时使用系统缓存目录下的 lexer_cache
+    static QString compiler;        // 编译器
+    static QStringList flags;       // 编译参数
+    static int maxEntries;          // 最多保留的可执行文件数
+
+    static QString directory();             // 实际使用的缓存目录
+    static QString keyOf(QString spec);     // 单词定义与生成选项对应的缓存键
+    static QString executable(QString spec, QString code, QString sourceFileName, QString *error);  // 取得可执行文件，未命中时编译
+    static void prune();                    // 删除超出 maxEntries 的最久未使用的可执行文件
+};
+
+#endif // LEXERCACHE_H
@@ -0,0 +1,142 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    literaltrie.cpp
+*  @brief   字面量单词双数组字典树实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "literaltrie.h"
+
+#include <QQueue>
+#include <QMap>
+
+LiteralTrie::LiteralTrie() {
+}
+
+/*!
+    @name   clear
+    @brief  清空
+    @param
+    @return
+    @attention
+*/
+void LiteralTrie::clear() {
+    base.clear();
+    check.clear();
+    token.clear();
+}
+
+/*!
+    @name   build
+    @brief  构造双数组字典树
+    @param  words （字面量字节串, 单词编号）列表
+    @return
+    @attention  先建普通字典树，再按广度优先顺序为每个结点寻找能容纳全部子结点的最小基址
+*/
+void LiteralTrie::build(QList<QPair<QByteArray, int>> words) {
+    clear();
+    if (words.empty()) return;
+
+    // 普通字典树，结点 0 为根
+    QVector<QMap<int, int>> children(1);
+    QVector<int> nodeToken(1, -1);
+    for (QPair<QByteArray, int> word: words) {
+        int node = 0;
+        for (char c: word.first) {
+            int code = (uchar)c + 1;
+            if (!children[node].contains(code)) {
+                children[node][code] = children.size();
+                children.append(QMap<int, int>());
+                nodeToken.append(-1);
+            }
+            node = children[node][code];
+        }
+        if (nodeToken[node] == -1) nodeToken[node] = word.second;
+    }
+
+    // 逐个结点放入双数组
+    auto reserve = [&](int size) {
+        while (check.size() < size) {
+            base.append(0);
+            check.append(0);
+            token.append(-1);
+        }
+    };
+    reserve(ROOT + 1);
+    check[ROOT] = -1;   // 根没有来源，标记为已占用
+    QVector<int> position(children.size());
+    position[0] = ROOT;
+    QQueue<int> q;
+    q.push_back(0);
+    int firstFree = ROOT + 1;   // 在它之前的位置都已占用
+    while (!q.empty()) {
+        int node = q.front();
+        q.pop_front();
+        int state = position[node];
+        token[state] = nodeToken[node];
+        if (children[node].empty()) continue;
+
+        QList<int> codes = children[node].keys();
+        while (firstFree < check.size() && check[firstFree] != 0) firstFree++;
+        int b = qMax(1, firstFree - codes.first());
+        while (true) {
+            reserve(b + codes.last() + 1);
+            bool ok = true;
+            for (int code: codes) {
+                if (check[b + code] != 0) {
+                    ok = false;
+                    break;
+                }
+            }
+            if (ok) break;
+            b++;
+        }
+        base[state] = b;
+        for (int code: codes) {
+            int child = children[node][code];
+            position[child] = b + code;
+            check[b + code] = state;
+            q.push_back(child);
+        }
+    }
+}
+
+/*!
+    @name   match
+    @brief  从 pos 开始的最长匹配
+    @param  src 源程序
+    @param  pos 开始位置
+    @param  tokenId 匹配成功时写入单词编号
+    @return 最长匹配长度，无法匹配时返回 -1
+    @attention  字面量按字节存储，编码不小于 256 的字符不能转移
+*/
+int LiteralTrie::match(const QString &src, int pos, int *tokenId) const {
+    if (empty()) return -1;
+    int state = ROOT;
+    int matchLen = -1;
+    if (token[state] >= 0) {
+        matchLen = 0;
+        *tokenId = token[state];
+    }
+    for (int i = pos; i < src.size(); i++) {
+        ushort c = src[i].unicode();
+        if (c >= 256) break;
+        int next = base[state] + c + 1;
+        if (next >= check.size() || check[next] != state) break;
+        state = next;
+        if (token[state] >= 0) {
+            matchLen = i - pos + 1;
+            *tokenId = token[state];
+        }
+    }
+    return matchLen;
+}
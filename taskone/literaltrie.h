@@ -0,0 +1,48 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    literaltrie.h
+*  @brief   字面量单词双数组字典树头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef LITERALTRIE_H
+#define LITERALTRIE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QPair>
+
+/*!
+    @name  LiteralTrie
+    @brief 全部字面量单词（运算符、界符等）合并成的双数组字典树：
+           状态 s 读入字节 c 转移到 t = base[s] + c + 1，当且仅当 check[t] == s；
+           分词是从当前位置开始的锚定匹配，不需要 Aho–Corasick 的失败指针
+*/
+class LiteralTrie
+{
+public:
+    LiteralTrie();
+    void clear();                                           // 清空
+    void build(QList<QPair<QByteArray, int>> words);        // 构造，同一字面量属于多个单词时先出现者优先
+    int match(const QString &src, int pos, int *tokenId) const;  // 从 pos 开始的最长匹配长度，无法匹配时返回 -1
+    bool empty() const { return base.empty(); }
+
+    static const int ROOT = 1;  // 根状态，0 号位置不使用，check 为 0 表示空闲
+
+    QVector<qint32> base;       // 转移基址
+    QVector<qint32> check;      // 转移来源状态
+    QVector<qint32> token;      // 终态接受的单词编号，非终态为 -1
+};
+
+#endif // LITERALTRIE_H
@@ -17,6 +17,9 @@
 #include "nfa.h"
 
 #include <QDebug>
+#include <QStringList>
+
+#include <algorithm>
 
 NFA::NFA(int begin, int end): startState(begin), endState(end), stateNum(0), maxStateNum(100) {
     G.resize(maxStateNum);
@@ -47,6 +50,8 @@ void NFA::clear() {
         G[i].resize(maxStateNum);
     }
     stateSet.clear();
+    acceptStates.clear();
+    tb.clear();
     stk.clear();
 }
 
@@ -119,6 +124,7 @@ void NFA::fromRegex(QString re) {
         stk.pop();
         startState = statePair.first;
         endState = statePair.second;
+        acceptStates = QSet<int>({endState});
     }
     if (!stk.empty()) {
         throw QString("NFA build ERROR!!!");
@@ -126,6 +132,159 @@ void NFA::fromRegex(QString re) {
     buildTb();
 }
 
+/*!
+    @name   optimize
+    @brief  NFA 约简：消除epsilon转移、删除不可达与死状态、合并前向行为相同的状态
+    @param
+    @return
+    @attention  只改写邻接表 tb 与 acceptStates，状态编号保持 Thompson 构造时的编号，
+                邻接矩阵 G 仍保留原始 NFA 供界面展示
+*/
+void NFA::optimize() {
+    // 1. epsilon 消除：只保留始态以及非epsilon转移的目标状态
+    QSet<int> keepStates;
+    keepStates.insert(startState);
+    for (int i = 0; i < stateNum; i++) {
+        for (QString changeItem: tb[i].keys()) {
+            if (changeItem == "epsilon" || changeItem == "") continue;
+            keepStates = keepStates.unite(tb[i][changeItem]);
+        }
+    }
+
+    QHash<int, QHash<QString, QSet<int>>> newTb;
+    QSet<int> newAcceptStates;
+    for (int state: keepStates) {
+        QSet<int> closure = epsilonClosure(QSet<int>({state}));
+        if (closure.intersects(acceptStates)) newAcceptStates.insert(state);
+        newTb[state] = QHash<QString, QSet<int>>();
+        for (int item: closure) {
+            for (QString changeItem: tb[item].keys()) {
+                if (changeItem == "epsilon" || changeItem == "") continue;
+                newTb[state][changeItem] = newTb[state][changeItem].unite(tb[item][changeItem]);
+            }
+        }
+    }
+
+    // 2. 删除不可达状态：从始态出发正向搜索
+    QSet<int> reachable;
+    QStack<int> searchStack;
+    reachable.insert(startState);
+    searchStack.push(startState);
+    while (!searchStack.empty()) {
+        int state = searchStack.pop();
+        for (QString changeItem: newTb[state].keys()) {
+            for (int nextState: newTb[state][changeItem]) {
+                if (!reachable.contains(nextState)) {
+                    reachable.insert(nextState);
+                    searchStack.push(nextState);
+                }
+            }
+        }
+    }
+
+    // 3. 删除死状态：从接受状态出发反向搜索
+    QHash<int, QSet<int>> revTb;
+    for (int state: reachable) {
+        for (QString changeItem: newTb[state].keys()) {
+            for (int nextState: newTb[state][changeItem]) {
+                revTb[nextState].insert(state);
+            }
+        }
+    }
+    QSet<int> alive;
+    for (int state: newAcceptStates) {
+        if (reachable.contains(state)) {
+            alive.insert(state);
+            searchStack.push(state);
+        }
+    }
+    while (!searchStack.empty()) {
+        int state = searchStack.pop();
+        for (int prevState: revTb[state]) {
+            if (!alive.contains(prevState)) {
+                alive.insert(prevState);
+                searchStack.push(prevState);
+            }
+        }
+    }
+    alive.insert(startState);   // 语言为空时也保留始态
+
+    for (int state: newTb.keys()) {
+        if (!alive.contains(state)) {
+            newTb.remove(state);
+            continue;
+        }
+        for (QString changeItem: newTb[state].keys()) {
+            QSet<int> targets = newTb[state][changeItem].intersect(alive);
+            if (targets.empty()) newTb[state].remove(changeItem);
+            else newTb[state][changeItem] = targets;
+        }
+    }
+    newAcceptStates = newAcceptStates.intersect(alive);
+
+    // 4. 合并前向行为相同的状态：从按是否接受划分开始，按转移签名不断细分直到稳定
+    QList<int> states = newTb.keys();
+    std::sort(states.begin(), states.end());
+    QHash<int, int> classOf;
+    for (int state: states) {
+        classOf[state] = newAcceptStates.contains(state) ? 1 : 0;
+    }
+    int classNum = -1;
+    while (true) {
+        QHash<QString, int> signatureHash;
+        QHash<int, int> newClassOf;
+        for (int state: states) {
+            QStringList changeList = newTb[state].keys();
+            std::sort(changeList.begin(), changeList.end());
+            QString signature = QString::number(classOf[state]);
+            for (QString changeItem: changeList) {
+                QSet<int> targetClasses;
+                for (int nextState: newTb[state][changeItem]) {
+                    targetClasses.insert(classOf[nextState]);
+                }
+                QList<int> targetList = targetClasses.values();
+                std::sort(targetList.begin(), targetList.end());
+                signature += ";" + QString::number(changeItem.size()) + ":" + changeItem;
+                for (int targetClass: targetList) {
+                    signature += "," + QString::number(targetClass);
+                }
+            }
+            if (!signatureHash.contains(signature)) {
+                int newClass = signatureHash.size();
+                signatureHash[signature] = newClass;
+            }
+            newClassOf[state] = signatureHash[signature];
+        }
+        classOf = newClassOf;
+        if (signatureHash.size() == classNum) break;
+        classNum = signatureHash.size();
+    }
+
+    // 每个等价类以最小编号的状态为代表
+    QHash<int, int> representative;
+    for (int state: states) {
+        if (!representative.contains(classOf[state])) {
+            representative[classOf[state]] = state;
+        }
+    }
+
+    tb.clear();
+    acceptStates.clear();
+    for (int state: states) {
+        int rep = representative[classOf[state]];
+        if (newAcceptStates.contains(state)) acceptStates.insert(rep);
+        if (rep != state) continue;
+        tb[rep] = QHash<QString, QSet<int>>();
+        for (QString changeItem: newTb[state].keys()) {
+            for (int nextState: newTb[state][changeItem]) {
+                tb[rep][changeItem].insert(representative[classOf[nextState]]);
+            }
+        }
+    }
+    startState = representative[classOf[startState]];
+    stateSet.remove("epsilon");
+}
+
 /*!
     @name   epsilonClosure
     @brief  求某状态集合的epsilon闭包
@@ -133,7 +292,7 @@ void NFA::fromRegex(QString re) {
     @return 状态集合 state 的转移闭包
     @attention
 */
-QSet<int> NFA::epsilonClosure(QSet<int> state) {
+QSet<int> NFA::epsilonClosure(QSet<int> state) const {
     QSet<int> rangeSet = state;
     while (true) {
         QSet<int> tmpSet;
@@ -146,9 +305,10 @@ QSet<int> NFA::epsilonClosure(QSet<int> state) {
 //                    }
 //                }
 //            }
-            // 邻接表构造
-            if (tb[item].contains("epsilon")) {
-                tmpSet = tmpSet.unite(tb[item]["epsilon"]);
+            // 邻接表构造（只读查找，可在多个线程中同时调用）
+            auto it = tb.constFind(item);
+            if (it != tb.constEnd() && it->contains("epsilon")) {
+                tmpSet = tmpSet.unite(it->value("epsilon"));
             }
         }
         if (tmpSet.empty() || state.contains(tmpSet)) break;
@@ -166,7 +326,7 @@ QSet<int> NFA::epsilonClosure(QSet<int> state) {
     @return 状态集合 state 经过 value 转移的闭包
     @attention
 */
-QSet<int> NFA::valueClosure(QSet<int> state, QString value) {
+QSet<int> NFA::valueClosure(QSet<int> state, QString value) const {
     QSet<int> result;
     for (int item: state) {
         // 邻接矩阵构造
@@ -175,9 +335,10 @@ QSet<int> NFA::valueClosure(QSet<int> state, QString value) {
 //                result.insert(i);
 //            }
 //        }
-        // 邻接表构造
-        if (tb[item].contains(value)) {
-            result = result.unite(tb[item][value]);
+        // 邻接表构造（只读查找，可在多个线程中同时调用）
+        auto it = tb.constFind(item);
+        if (it != tb.constEnd() && it->contains(value)) {
+            result = result.unite(it->value(value));
         }
     }
     return epsilonClosure(result);
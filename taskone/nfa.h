@@ -22,6 +22,7 @@
 #include <QVector>
 #include <QStack>
 #include <QPair>
+#include <QHash>
 
 /*!
     @name  NFA
@@ -34,10 +35,11 @@ public:
     void allocateMemory(int num);   // 检查插入 num 状态数量后是否超过空间
     void clear();                   // 清空NFA
     void fromRegex(QString re);     // 利用后缀正则表达式构造NFA
+    void optimize();                // epsilon消除与状态约简
 
     // 闭包函数
-    QSet<int> epsilonClosure(QSet<int> state);  // 计算epsilon闭包
-    QSet<int> valueClosure(QSet<int> state, QString value); // 计算某个集合状态能通过value转移到的状态集合
+    QSet<int> epsilonClosure(QSet<int> state) const;  // 计算epsilon闭包
+    QSet<int> valueClosure(QSet<int> state, QString value) const; // 计算某个集合状态能通过value转移到的状态集合
 
     // 构造NFA的中间辅助函数
     void nfaChange(QString str);
@@ -56,6 +58,7 @@ public:
     QSet<QString> stateSet;             // 存储所有状态类型
     int startState;                     // 表示起始状态
     int endState;                       // 表示终止状态
+    QSet<int> acceptStates;             // 接受状态集合（epsilon消除后可能有多个）
     int stateNum;                       // 表示状态数量
     int maxStateNum;                    // 表示当前最多存储的状态数量
 
@@ -0,0 +1,440 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    regexsimplifier.cpp
+*  @brief   正则表达式代数化简实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "regexsimplifier.h"
+
+#include <QStack>
+#include <QSet>
+
+#include <algorithm>
+
+static const int MAX_ROUNDS = 8;                    // 改写轮数上限
+static const QString ESCAPED_CHARS = "|.*+?#\\()";  // 输出时需要转义的字符
+
+RegexSimplifier::RegexSimplifier() {
+    this->clear();
+}
+
+/*!
+    @name   clear
+    @brief  清空项表，编号 0 为空串
+    @param
+    @return
+    @attention
+*/
+void RegexSimplifier::clear() {
+    terms.clear();
+    termHash.clear();
+    regexCache.clear();
+    intern(RegexTerm::Epsilon);
+}
+
+/*!
+    @name   simplify
+    @brief  化简后缀正则表达式
+    @param  re 后缀正则表达式
+    @return 化简后的后缀正则表达式，与 re 表示相同的语言
+    @attention  反复解析、输出直到结果不再变化；格式错误时原样返回，由构造 NFA 时报错
+*/
+QString RegexSimplifier::simplify(QString re) {
+    for (int round = 0; round < MAX_ROUNDS; round++) {
+        int term = fromRegex(re);
+        if (term < 0) return re;
+        QString result = toRegex(term);
+        if (result == re) break;
+        re = result;
+    }
+    return re;
+}
+
+/*!
+    @name   fromRegex
+    @brief  将后缀正则表达式转换为化简后的项
+    @param  re 后缀正则表达式
+    @return 项编号，格式错误时返回 -1
+    @attention  运算符与 NFA::fromRegex 一致
+*/
+int RegexSimplifier::fromRegex(QString re) {
+    QStack<int> stk;
+    for (int i = 0; i < re.size(); i++) {
+        switch (re[i].unicode()) {
+        case '\\':
+            i++;
+            if (i < re.size()) stk.push(chr(QString(re[i])));
+            break;
+        case '|':
+        case '.': {
+            if (stk.size() < 2) return -1;
+            int right = stk.pop();
+            int left = stk.pop();
+            stk.push(re[i] == '|' ? alt(QVector<int>({left, right})) : cat(QVector<int>({left, right})));
+            break;
+        }
+        case '*':
+        case '+':
+        case '?': {
+            if (stk.empty()) return -1;
+            int item = stk.pop();
+            if (re[i] == '*') stk.push(star(item));
+            else if (re[i] == '+') stk.push(plus(item));
+            else stk.push(option(item));
+            break;
+        }
+        case '#':
+            stk.push(epsilon());
+            break;
+        default:
+            stk.push(chr(QString(re[i])));
+            break;
+        }
+    }
+    if (stk.size() != 1) return -1;
+    return stk.top();
+}
+
+/*!
+    @name   toRegex
+    @brief  项转换为后缀正则表达式
+    @param  term 项编号
+    @return 后缀正则表达式
+    @attention  多元的或、连接左结合输出；共享的子项只生成一次
+*/
+QString RegexSimplifier::toRegex(int term) {
+    if (regexCache.contains(term)) return regexCache[term];
+    RegexTerm item = terms[term];
+    QString re;
+    switch (item.type) {
+    case RegexTerm::Epsilon:
+        re = "#";
+        break;
+    case RegexTerm::Char:
+        re = ESCAPED_CHARS.contains(item.ch) ? "\\" + item.ch : item.ch;
+        break;
+    case RegexTerm::Alt:
+    case RegexTerm::Cat: {
+        QString op = item.type == RegexTerm::Alt ? "|" : ".";
+        re = toRegex(item.operands[0]);
+        for (int i = 1; i < item.operands.size(); i++) {
+            re += toRegex(item.operands[i]) + op;
+        }
+        break;
+    }
+    case RegexTerm::Star:
+        re = toRegex(item.operands[0]) + "*";
+        break;
+    case RegexTerm::Plus:
+        re = toRegex(item.operands[0]) + "+";
+        break;
+    case RegexTerm::Option:
+        re = toRegex(item.operands[0]) + "?";
+        break;
+    }
+    regexCache[term] = re;
+    return re;
+}
+
+/*!
+    @name   intern
+    @brief  哈希共享：相同的项只分配一个编号
+    @param  type 项类型
+    @param  operands 子项
+    @param  ch 字符
+    @return 项编号
+    @attention
+*/
+int RegexSimplifier::intern(RegexTerm::Type type, QVector<int> operands, QString ch) {
+    QString key = QString::number(type) + " " + ch;
+    for (int item: operands) {
+        key += " " + QString::number(item);
+    }
+    if (termHash.contains(key)) return termHash[key];
+
+    RegexTerm term;
+    term.type = type;
+    term.ch = ch;
+    term.operands = operands;
+    switch (type) {
+    case RegexTerm::Epsilon:
+    case RegexTerm::Star:
+    case RegexTerm::Option:
+        term.nullable = true;
+        break;
+    case RegexTerm::Alt:
+        term.nullable = false;
+        for (int item: operands) term.nullable = term.nullable || terms[item].nullable;
+        break;
+    case RegexTerm::Cat:
+        term.nullable = true;
+        for (int item: operands) term.nullable = term.nullable && terms[item].nullable;
+        break;
+    case RegexTerm::Plus:
+        term.nullable = terms[operands[0]].nullable;
+        break;
+    default:
+        term.nullable = false;
+        break;
+    }
+    terms.append(term);
+    termHash[key] = terms.size() - 1;
+    return terms.size() - 1;
+}
+
+/*!
+    @name   head
+    @brief  连接的第一个子项，其他项为自身
+    @param  term 项编号
+    @return 项编号
+    @attention
+*/
+int RegexSimplifier::head(int term) {
+    if (terms[term].type == RegexTerm::Cat) return terms[term].operands.first();
+    return term;
+}
+
+/*!
+    @name   tail
+    @brief  连接去掉第一个子项后的其余子项，其他项为空
+    @param  term 项编号
+    @return 子项列表
+    @attention
+*/
+QVector<int> RegexSimplifier::tail(int term) {
+    if (terms[term].type == RegexTerm::Cat) return terms[term].operands.mid(1);
+    return QVector<int>();
+}
+
+int RegexSimplifier::epsilon() {
+    return 0;
+}
+
+int RegexSimplifier::chr(QString value) {
+    return intern(RegexTerm::Char, QVector<int>(), value);
+}
+
+/*!
+    @name   alt
+    @brief  或：展开嵌套的或并去重，ε|r = r?，r|r* = r*，r|r+ = r+，r+|r* = r*，
+            ab|ac = a(b|c)
+    @param  operands 操作数
+    @return 项编号
+    @attention  单个字符排在前面并按字符排序，其余按正则文本排序，交换律下形式唯一
+*/
+int RegexSimplifier::alt(QVector<int> operands) {
+    QVector<int> items;
+    bool nullable = false;
+    for (int item: operands) {
+        const RegexTerm &term = terms[item];
+        if (term.type == RegexTerm::Alt) {
+            items += term.operands;
+        } else if (term.type == RegexTerm::Option) {
+            nullable = true;
+            items.append(term.operands[0]);
+        } else if (item == epsilon()) {
+            nullable = true;
+        } else {
+            items.append(item);
+        }
+    }
+
+    // 去重，并删除被闭包包含的操作数
+    QSet<int> starred;      // 以 x* 形式出现的 x
+    QSet<int> plussed;      // 以 x+ 形式出现的 x
+    for (int item: items) {
+        if (terms[item].type == RegexTerm::Star) starred.insert(terms[item].operands[0]);
+        if (terms[item].type == RegexTerm::Plus) plussed.insert(terms[item].operands[0]);
+    }
+    QVector<int> kept;
+    for (int item: items) {
+        if (kept.contains(item) || starred.contains(item) || plussed.contains(item)) continue;
+        if (terms[item].type == RegexTerm::Plus && starred.contains(terms[item].operands[0])) continue;
+        kept.append(item);
+    }
+    std::sort(kept.begin(), kept.end(), [&](int a, int b) {
+        bool charA = terms[a].type == RegexTerm::Char;
+        bool charB = terms[b].type == RegexTerm::Char;
+        if (charA != charB) return charA;
+        if (charA) return terms[a].ch < terms[b].ch;
+        return toRegex(a) < toRegex(b);     // 按结构排序，项编号取决于各单词化简的先后，不能作为顺序
+    });
+
+    // 提取公共前缀
+    QVector<int> result;
+    QVector<bool> used(kept.size(), false);
+    for (int i = 0; i < kept.size(); i++) {
+        if (used[i]) continue;
+        int prefix = head(kept[i]);
+        QVector<int> rests;
+        for (int j = i; j < kept.size(); j++) {
+            if (used[j] || head(kept[j]) != prefix) continue;
+            used[j] = true;
+            rests.append(cat(tail(kept[j])));
+        }
+        if (rests.size() == 1) result.append(kept[i]);
+        else result.append(cat(QVector<int>({prefix, alt(rests)})));
+    }
+
+    if (result.empty()) return epsilon();
+    int term = result.size() == 1 ? result[0] : intern(RegexTerm::Alt, result);
+    return nullable ? option(term) : term;
+}
+
+/*!
+    @name   cat
+    @brief  连接：展开嵌套的连接，εr = rε = r，rr* = r*r = r+，r*r* = r*，r+r* = r*r+ = r+
+    @param  operands 操作数
+    @return 项编号
+    @attention  r 可以是多个子项的连接，如 ab(ab)* = (ab)+
+*/
+int RegexSimplifier::cat(QVector<int> operands) {
+    QVector<int> items;
+    for (int item: operands) {
+        if (terms[item].type == RegexTerm::Cat) items += terms[item].operands;
+        else if (item != epsilon()) items.append(item);
+    }
+
+    // closure 为闭包 x* 时，x 作为连接展开后的子项序列
+    auto body = [&](int closure) {
+        int x = terms[closure].operands[0];
+        return terms[x].type == RegexTerm::Cat ? terms[x].operands : QVector<int>({x});
+    };
+    QVector<int> result;
+    for (int item: items) {
+        result.append(item);
+        bool changed = true;
+        while (changed && result.size() >= 2) {
+            changed = false;
+            int n = result.size();
+            int last = result[n - 1];
+            int prev = result[n - 2];
+            const RegexTerm &lastTerm = terms[last];
+            const RegexTerm &prevTerm = terms[prev];
+            bool lastClosure = lastTerm.type == RegexTerm::Star || lastTerm.type == RegexTerm::Plus;
+            bool prevClosure = prevTerm.type == RegexTerm::Star || prevTerm.type == RegexTerm::Plus;
+
+            // r*r* = r*，r+r* = r*r+ = r+
+            if (lastClosure && prevClosure && lastTerm.operands == prevTerm.operands) {
+                if (lastTerm.type == RegexTerm::Star && prevTerm.type == RegexTerm::Star) {
+                    result.removeLast();
+                    changed = true;
+                } else if (lastTerm.type != prevTerm.type) {
+                    int merged = plus(lastTerm.operands[0]);
+                    result.resize(n - 2);
+                    result.append(merged);
+                    changed = true;
+                }
+                continue;
+            }
+
+            // rr* = r+
+            if (lastTerm.type == RegexTerm::Star) {
+                QVector<int> seq = body(last);
+                if (n - 1 >= seq.size() && result.mid(n - 1 - seq.size(), seq.size()) == seq) {
+                    int merged = plus(lastTerm.operands[0]);
+                    result.resize(n - 1 - seq.size());
+                    result.append(merged);
+                    changed = true;
+                    continue;
+                }
+            }
+
+            // r*r = r+
+            for (int k = 1; k < n && !changed; k++) {
+                int closure = result[n - 1 - k];
+                if (terms[closure].type != RegexTerm::Star) continue;
+                QVector<int> seq = body(closure);
+                if (seq.size() == k && result.mid(n - k) == seq) {
+                    int merged = plus(terms[closure].operands[0]);
+                    result.resize(n - 1 - k);
+                    result.append(merged);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    if (result.empty()) return epsilon();
+    if (result.size() == 1) return result[0];
+    return intern(RegexTerm::Cat, result);
+}
+
+/*!
+    @name   star
+    @brief  闭包：ε* = ε，(r*)* = (r+)* = (r?)* = r*，(r*|s)* = (r|s)*，(r?s*)* = (r|s)*
+    @param  a
+    @return 项编号
+    @attention
+*/
+int RegexSimplifier::star(int a) {
+    if (a == epsilon()) return a;
+
+    // terms 会在构造过程中扩容，不能持有引用
+    RegexTerm item = terms[a];
+    switch (item.type) {
+    case RegexTerm::Star:
+        return a;
+    case RegexTerm::Plus:
+    case RegexTerm::Option:
+        return star(item.operands[0]);
+    case RegexTerm::Alt:
+    case RegexTerm::Cat: {
+        // 闭包内的或去掉各操作数的闭包；可以匹配空串的连接改为各子项的或
+        if (item.type == RegexTerm::Cat && !item.nullable) break;
+        QVector<int> operands;
+        bool changed = item.type == RegexTerm::Cat;
+        for (int operand: item.operands) {
+            RegexTerm::Type type = terms[operand].type;
+            if (type == RegexTerm::Star || type == RegexTerm::Plus || type == RegexTerm::Option) {
+                operands.append(terms[operand].operands[0]);
+                changed = true;
+            } else {
+                operands.append(operand);
+            }
+        }
+        if (changed) return star(alt(operands));
+        break;
+    }
+    default:
+        break;
+    }
+    return intern(RegexTerm::Star, QVector<int>({a}));
+}
+
+/*!
+    @name   plus
+    @brief  正闭包：ε+ = ε，(r+)+ = r+，r 可以匹配空串时 r+ = r*
+    @param  a
+    @return 项编号
+    @attention
+*/
+int RegexSimplifier::plus(int a) {
+    if (a == epsilon()) return a;
+    if (terms[a].nullable) return star(a);
+    if (terms[a].type == RegexTerm::Plus) return a;
+    return intern(RegexTerm::Plus, QVector<int>({a}));
+}
+
+/*!
+    @name   option
+    @brief  可选：r 可以匹配空串时 r? = r，(r+)? = r*
+    @param  a
+    @return 项编号
+    @attention
+*/
+int RegexSimplifier::option(int a) {
+    if (terms[a].nullable) return a;
+    if (terms[a].type == RegexTerm::Plus) return star(terms[a].operands[0]);
+    return intern(RegexTerm::Option, QVector<int>({a}));
+}
@@ -0,0 +1,73 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    regexsimplifier.h
+*  @brief   正则表达式代数化简头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef REGEXSIMPLIFIER_H
+#define REGEXSIMPLIFIER_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+
+/*!
+    @name  RegexTerm
+    @brief 化简后的正则表达式项，通过编号相互引用
+*/
+class RegexTerm
+{
+public:
+    enum Type { Epsilon, Char, Alt, Cat, Star, Plus, Option };
+
+    Type type;              // 项类型
+    QString ch;             // Char 项的字符
+    QVector<int> operands;  // 子项编号：Alt、Cat 至少两个，闭包与可选恰好一个
+    bool nullable;          // 是否可以匹配空串
+};
+
+/*!
+    @name  RegexSimplifier
+    @brief 在构造 NFA 之前化简后缀正则表达式：智能构造函数在建项时应用代数规则，
+           相同的项哈希共享，反复改写直到后缀形式不再变化
+*/
+class RegexSimplifier
+{
+public:
+    RegexSimplifier();
+    void clear();                       // 清空项表
+    QString simplify(QString re);       // 化简后缀正则表达式
+    int fromRegex(QString re);          // 利用后缀正则表达式构造项，格式错误时返回 -1
+    QString toRegex(int term);          // 项转换为后缀正则表达式
+
+    // 智能构造函数
+    int epsilon();                      // 空串
+    int chr(QString value);             // 单个字符
+    int alt(QVector<int> operands);     // 或
+    int cat(QVector<int> operands);     // 连接
+    int star(int a);                    // 闭包
+    int plus(int a);                    // 正闭包
+    int option(int a);                  // 可选
+
+    QVector<RegexTerm> terms;           // 项表
+
+private:
+    int intern(RegexTerm::Type type, QVector<int> operands = QVector<int>(), QString ch = "");
+    int head(int term);
+    QVector<int> tail(int term);
+
+    QHash<QString, int> termHash;       // 项到编号的映射
+    QHash<int, QString> regexCache;     // 项到后缀正则表达式的缓存
+};
+
+#endif // REGEXSIMPLIFIER_H
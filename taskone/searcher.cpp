@@ -0,0 +1,285 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    searcher.cpp
+*  @brief   单词模式的非锚定搜索实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "searcher.h"
+#include "nfa.h"
+
+#include <QFile>
+#include <QtConcurrent>
+
+#include <vector>
+
+// 不能映射时整个读入内存，QByteArray、QString 的长度都受 int 限制，只处理 1 GiB 以内的文件
+static const qint64 MAX_DECODED_SIZE = qint64(1) << 30;
+
+Searcher::Searcher(): byteLevel(true) {
+}
+
+/*!
+    @name   reverseSearchNFA
+    @brief  DFA 的反向自动机，并在新始态上加 Σ* 自环
+    @param  dfa 最小化 DFA
+    @return NFA，新始态为 dfa.stateNum，经 epsilon 转移到原终态，原始态为终态
+    @attention  从文本末尾倒着读到位置 i 时处于终态，当且仅当 text[i..] 有属于原语言的前缀，
+                即 i 是某个匹配的起点；新始态在每个字符上转移到自身
+*/
+static NFA reverseSearchNFA(const DFA &dfa) {
+    NFA nfa;
+    int n = dfa.stateNum;
+    for (QString changeItem: dfa.changeSet) {
+        if (changeItem != "epsilon") nfa.stateSet.insert(changeItem);
+    }
+    for (int i = 0; i < n; i++) {
+        QHash<QString, int> edges = dfa.G.value(i);
+        for (auto it = edges.constBegin(); it != edges.constEnd(); it++) {
+            nfa.tb[it.value()][it.key()].insert(i);
+        }
+    }
+    for (QString changeItem: nfa.stateSet) {
+        nfa.tb[n][changeItem].insert(n);
+    }
+    nfa.stateSet.insert("epsilon");
+    nfa.tb[n]["epsilon"] = dfa.endStates;
+    nfa.startState = n;
+    nfa.acceptStates = QSet<int>({dfa.startState});
+    nfa.stateNum = n + 1;
+    return nfa;
+}
+
+/*!
+    @name   determinize
+    @brief  NFA 确定化并最小化
+    @param  nfa
+    @return 最小化 DFA 的连续转移表
+    @attention
+*/
+static DFATable determinize(const NFA &nfa) {
+    DFA dfa;
+    dfa.fromNFA(nfa, false);
+    DFA minidfa;
+    minidfa.fromDFA(dfa, false);
+    return minidfa.table;
+}
+
+/*!
+    @name   build
+    @brief  由单词的最小化 DFA 构造
+    @param  minidfa 单词的最小化 DFA
+    @param  utf8 minidfa 是否为 UTF-8 字节自动机
+    @return
+    @attention
+*/
+void Searcher::build(const DFA &minidfa, bool utf8) {
+    anchored = minidfa.table;
+    reverse = DFATable();
+    byteLevel = true;
+    if (minidfa.stateNum == 0) return;
+    reverse = determinize(reverseSearchNFA(minidfa));
+    if (!utf8) {
+        for (QString changeItem: minidfa.changeSet) {
+            if (changeItem == "epsilon") continue;
+            if (changeItem.size() != 1 || changeItem[0].unicode() >= 0x80) byteLevel = false;
+        }
+    }
+}
+
+static inline int classOf(const DFATable &table, char c) {
+    return table.latinClass((uchar)c);
+}
+
+static inline int classOf(const DFATable &table, QChar c) {
+    return table.charClass(c);
+}
+
+static inline QString textOf(const char *p, qint64 n) {
+    return QString::fromUtf8(p, int(n));
+}
+
+static inline QString textOf(const QChar *p, qint64 n) {
+    return QString(p, int(n));
+}
+
+/*!
+    @name   runSearch
+    @brief  在字符序列中搜索，Ch 为 char（字节）或 QChar
+    @param  s 搜索器
+    @param  text 字符序列
+    @param  size 长度
+    @return 全部匹配，互不重叠
+    @attention  1. reverse 从文本末尾倒着扫描一遍，标出全部可能的起点，遇到字母表外的字符回到始态；
+                2. 从 pos 开始找第一个起点，anchored 从该起点取最长匹配，下一次从匹配之后开始。
+                得到最左最长的匹配；空匹配不报告，从下一个位置继续。
+                起点位图用 std::vector<bool>，下标为 64 位，超过 2 GiB 的映射文件不会截断
+*/
+template <typename Ch>
+static QList<SearchMatch> runSearch(const Searcher &s, const Ch *text, qint64 size) {
+    QList<SearchMatch> matches;
+    if (s.reverse.stateNum == 0) return matches;
+
+    std::vector<bool> starts(size_t(size), false);
+    int state = s.reverse.startState;
+    for (qint64 i = size - 1; i >= 0; i--) {
+        state = s.reverse.next(state, classOf(s.reverse, text[i]));
+        if (state == s.reverse.deadState) state = s.reverse.startState;
+        if (s.reverse.isAccept(state)) starts[size_t(i)] = true;
+    }
+
+    qint64 pos = 0;
+    qint64 lineFrom = 0;
+    int line = 1;
+    while (pos < size) {
+        while (pos < size && !starts[size_t(pos)]) pos++;
+        if (pos >= size) break;
+
+        state = s.anchored.startState;
+        qint64 length = 0;
+        for (qint64 i = pos; i < size; i++) {
+            state = s.anchored.next(state, classOf(s.anchored, text[i]));
+            if (state == s.anchored.deadState) break;
+            if (s.anchored.isAccept(state)) length = i - pos + 1;
+        }
+        if (length == 0) {
+            pos++;
+            continue;
+        }
+
+        for (; lineFrom < pos; lineFrom++) {
+            if (text[lineFrom] == '\n') line++;
+        }
+        SearchMatch match;
+        match.offset = pos;
+        match.length = length;
+        match.line = line;
+        match.text = textOf(text + pos, length);
+        matches.append(match);
+        pos += length;
+    }
+    return matches;
+}
+
+/*!
+    @name   searchBytes
+    @brief  在字节串中搜索
+    @param  data 字节串
+    @param  size 长度
+    @return 全部匹配，偏移为字节偏移
+    @attention  只在 byteLevel 时使用：每个字节直接查 256 项的字符类映射
+*/
+QList<SearchMatch> Searcher::searchBytes(const char *data, qint64 size) const {
+    return runSearch(*this, data, size);
+}
+
+/*!
+    @name   searchText
+    @brief  在字符串中搜索
+    @param  text 字符串
+    @return 全部匹配，偏移为字符偏移
+    @attention
+*/
+QList<SearchMatch> Searcher::searchText(const QString &text) const {
+    return runSearch(*this, text.constData(), text.size());
+}
+
+/*!
+    @name   searchFile
+    @brief  映射文件后搜索
+    @param  fileName 文件名
+    @param  error 失败时写入错误信息
+    @return 全部匹配
+    @attention  byteLevel 时直接在映射的内存上搜索，不复制文件内容；
+                否则按 UTF-8 解码后搜索，QString 装不下的大文件报错
+*/
+QList<SearchMatch> Searcher::searchFile(QString fileName, QString *error) const {
+    QList<SearchMatch> matches;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = fileName + "：无法读取";
+        return matches;
+    }
+    qint64 size = file.size();
+    if (size == 0) return matches;
+    if (!byteLevel && size > MAX_DECODED_SIZE) {
+        *error = fileName + "：文件过大，含非 ASCII 字符的模式只能搜索 1 GiB 以内的文件，可改用 UTF-8 字节自动机";
+        return matches;
+    }
+    if (byteLevel) {
+        uchar *data = file.map(0, size);
+        if (data) {
+            matches = searchBytes(reinterpret_cast<const char *>(data), size);
+            file.unmap(data);
+        } else if (size > MAX_DECODED_SIZE) {
+            *error = fileName + "：文件映射失败";
+            return matches;
+        } else {
+            QByteArray content = file.readAll();
+            matches = searchBytes(content.constData(), content.size());
+        }
+    } else {
+        matches = searchText(QString::fromUtf8(file.readAll()));
+    }
+    file.close();
+    for (SearchMatch &match: matches) {
+        match.fileName = fileName;
+    }
+    return matches;
+}
+
+/*!
+    @name  FileSearcher
+    @brief 供 QtConcurrent::mapped 调用的 searchFile
+*/
+class FileSearcher
+{
+public:
+    typedef Searcher::FileResult result_type;
+
+    FileSearcher(const Searcher *searcher): searcher(searcher) {}
+    result_type operator()(const QString &fileName) const {
+        QString error;
+        QList<SearchMatch> matches = searcher->searchFile(fileName, &error);
+        return qMakePair(matches, error);
+    }
+
+    const Searcher *searcher;
+};
+
+/*!
+    @name   searchFiles
+    @brief  在线程池中搜索多个文件
+    @param  fileNames 文件列表
+    @return 立即返回，每个文件一个结果，由 collect 合并
+    @attention  两张转移表只读共享；不等待搜索结束，完成之前搜索器不能修改或销毁
+*/
+QFuture<Searcher::FileResult> Searcher::searchFiles(QStringList fileNames) const {
+    return QtConcurrent::mapped(fileNames, FileSearcher(this));
+}
+
+/*!
+    @name   collect
+    @brief  合并各文件的搜索结果
+    @param  future 已完成的 searchFiles
+    @param  errors 写入出错文件的错误信息
+    @return 全部匹配，按文件列表的顺序排列
+    @attention
+*/
+QList<SearchMatch> Searcher::collect(const QFuture<FileResult> &future, QStringList *errors) {
+    QList<SearchMatch> matches;
+    for (const FileResult &result: future.results()) {
+        matches.append(result.first);
+        if (!result.second.isEmpty()) errors->append(result.second);
+    }
+    return matches;
+}
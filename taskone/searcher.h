@@ -0,0 +1,66 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    searcher.h
+*  @brief   单词模式的非锚定搜索头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef SEARCHER_H
+#define SEARCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QFuture>
+
+#include "dfa.h"
+
+/*!
+    @name  SearchMatch
+    @brief 一处匹配
+*/
+struct SearchMatch
+{
+    QString fileName;   // 所在文件
+    qint64 offset;      // 起始位置：按字节搜索时为字节偏移，否则为字符偏移
+    qint64 length;      // 长度，单位同 offset
+    int line;           // 所在行，从 1 开始
+    QString text;       // 匹配的文本
+};
+
+/*!
+    @name  Searcher
+    @brief 在文件中查找单词模式的全部出现（最左最长）：
+           reverse 为反向 DFA 在始态前加 Σ* 自环后确定化、最小化得到的 DFA，从文本末尾倒着扫描一遍即可标出全部起点；
+           再用原 DFA 从每个未被覆盖的起点取最长匹配
+*/
+class Searcher
+{
+public:
+    typedef QPair<QList<SearchMatch>, QString> FileResult;     // 一个文件的匹配与错误信息
+
+    Searcher();
+    void build(const DFA &minidfa, bool utf8);      // 由单词的最小化 DFA 构造
+    QList<SearchMatch> searchBytes(const char *data, qint64 size) const;     // 在字节串中搜索
+    QList<SearchMatch> searchText(const QString &text) const;                // 在字符串中搜索
+    QList<SearchMatch> searchFile(QString fileName, QString *error) const;   // 映射文件后搜索
+    QFuture<FileResult> searchFiles(QStringList fileNames) const;     // 在线程池中搜索多个文件，不等待结束
+    static QList<SearchMatch> collect(const QFuture<FileResult> &future, QStringList *errors);  // 按文件顺序合并结果
+
+    DFATable anchored;      // 原 DFA，从起点取最长匹配
+    DFATable reverse;       // Σ* 前缀的反向 DFA，倒着扫描标出匹配的起点
+    bool byteLevel;         // 字母表只含 ASCII 字符或为 UTF-8 字节自动机，可以直接在映射的字节上搜索
+};
+
+#endif // SEARCHER_H
@@ -18,6 +18,9 @@
 #include "ui_taskonewidget.h"
 
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
 #include <QTextStream>
 #include <QString>
 #include <QStringList>
@@ -28,8 +31,222 @@
 #include <QException>
 #include <QDateTime>
 #include <QProcess>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QtConcurrent>
+
+#include <algorithm>
 
 #include "../taskone/utils/utils.h"
+#include "automatacache.h"
+#include "automatonmodel.h"
+#include "keywordhash.h"
+#include "lexercache.h"
+#include "literaltrie.h"
+#include "regexsimplifier.h"
+#include "searcher.h"
+
+// 约简后状态数不少于该值的 NFA 使用并行子集构造
+static const int PARALLEL_NFA_STATES = 1000;
+
+// 字面量单词展开后的字符串数量上限，超过时仍走 Thompson 构造
+static const int MAX_LITERAL_REGEX = 4096;
+
+// 搜索结果表最多显示的行数
+static const int MAX_SEARCH_ROWS = 10000;
+
+/*!
+    @name  TokenAutomata
+    @brief 单个单词的 NFA、DFA、最小化 DFA 构造结果
+*/
+class TokenAutomata
+{
+public:
+    QString key;        // 单词名称
+    NFA nfa;            // Thompson 构造的 NFA，用于展示
+    DFA dfa;            // 约简后的 NFA 经子集构造得到的 DFA
+    DFA minidfa;        // 最小化 DFA
+    QString error;      // 构造失败时的错误信息
+    bool cached;        // 是否从磁盘缓存读取，此时 nfa 为空，展示时再构造；字面量单词同样不构造 nfa
+};
+
+/*!
+    @name   buildTokenAutomata
+    @brief  构造单个单词的 NFA、DFA、最小化 DFA
+    @param  item 单词名称与后缀正则表达式
+    @param  literalTrie 字面量单词是否直接构造字典树
+    @param  keepMapping 是否保留 DFA 的状态来源
+    @return 构造结果
+    @attention  在线程池中执行，异常不能跨线程抛出，因此转换为 error
+*/
+static TokenAutomata buildTokenAutomata(const QPair<QString, QString> &item, bool literalTrie, bool keepMapping) {
+    TokenAutomata automata;
+    automata.key = item.first;
+    automata.cached = AutomataCache::load(item.second, keepMapping, automata.dfa, automata.minidfa);
+    if (automata.cached) return automata;
+    try {
+        QStringList literalList;
+        if (literalTrie) literalList = regexLiterals(item.second, MAX_LITERAL_REGEX);
+        if (!literalList.empty()) {
+            automata.dfa.fromWords(literalList);    // 跳过 Thompson 构造与子集构造
+        } else {
+            automata.nfa.fromRegex(item.second);
+            NFA nfa = automata.nfa;     // 展示用的 NFA 保持 Thompson 构造结果
+            nfa.optimize();             // 约简后再做子集构造
+            if (nfa.tb.size() >= PARALLEL_NFA_STATES) automata.dfa.fromNFAParallel(nfa, keepMapping);
+            else automata.dfa.fromNFA(nfa, keepMapping);
+        }
+        automata.minidfa.fromDFA(automata.dfa, keepMapping);
+        AutomataCache::save(item.second, keepMapping, automata.dfa, automata.minidfa);
+    } catch (QString e) {
+        automata.error = e;
+    } catch (...) {
+        automata.error = "未知错误";
+    }
+    return automata;
+}
+
+/*!
+    @name  TokenAutomataBuilder
+    @brief 供 QtConcurrent::blockingMapped 调用的 buildTokenAutomata
+*/
+class TokenAutomataBuilder
+{
+public:
+    typedef TokenAutomata result_type;
+
+    TokenAutomataBuilder(bool literalTrie, bool keepMapping): literalTrie(literalTrie), keepMapping(keepMapping) {}
+    TokenAutomata operator()(const QPair<QString, QString> &item) const {
+        return buildTokenAutomata(item, literalTrie, keepMapping);
+    }
+
+    bool literalTrie;
+    bool keepMapping;
+};
+
+/*!
+    @name   sourceFiles
+    @brief  目录下（含子目录）的全部源文件
+    @param  dirName 目录
+    @return 文件列表，不含分词结果 .lex 文件
+    @attention
+*/
+static QStringList sourceFiles(QString dirName) {
+    QStringList fileNames;
+    QDirIterator it(dirName, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString fileName = it.next();
+        if (!fileName.endsWith(".lex")) fileNames.append(fileName);
+    }
+    return fileNames;
+}
+
+/*!
+    @name   nonLatin1Char
+    @brief  DFA 转移中第一个编码不小于 256 的字符
+    @param  dfa
+    @return 没有时返回空字符
+    @attention
+*/
+static QChar nonLatin1Char(const DFA &dfa) {
+    for (const QHash<QString, int> &edges: dfa.G) {
+        for (auto it = edges.constBegin(); it != edges.constEnd(); ++it) {
+            if (it.key()[0].unicode() >= 256) return it.key()[0];
+        }
+    }
+    return QChar();
+}
+
+/*!
+    @name   charLiteral
+    @brief  生成转移字符对应的 C++ 字符字面量
+    @param  changeItem 转移字符
+    @return 字符字面量
+    @attention  引号、反斜杠以及非可打印字符（如 UTF-8 字节自动机中的字节）需要转义；
+                分析时已拒绝非 UTF-8 模式下编码不小于 256 的字符，转义后总是单字节字面量
+*/
+static QString charLiteral(QString changeItem) {
+    ushort code = changeItem[0].unicode();
+    if (code == '\'' || code == '\\') return QString("'\\") + changeItem + "'";
+    if (code < 0x20 || code >= 0x7F) return QString("'\\x%1'").arg(code, 2, 16, QChar('0'));
+    return "'" + changeItem + "'";
+}
+
+/*!
+    @name   sortedKeys
+    @brief  按字符排序的转移字符
+    @param  edges 一个状态的转移
+    @return
+    @attention  QHash 的遍历顺序随进程的随机种子变化，生成代码时按排序后的顺序遍历
+*/
+static QStringList sortedKeys(const QHash<QString, int> &edges) {
+    QStringList keys = edges.keys();
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+/*!
+    @name   sortedStates
+    @brief  按编号排序的状态集合
+    @param  states 状态集合
+    @return
+    @attention
+*/
+static QList<int> sortedStates(const QSet<int> &states) {
+    QList<int> list = states.toList();
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+/*!
+    @name   stringLiteral
+    @brief  生成字节串对应的 C++ 字符串字面量
+    @param  bytes 字节串
+    @return 字符串字面量
+    @attention  非可打印字节用定长三位八进制转义，避免与后续字符连成一个转义序列
+*/
+static QString stringLiteral(QByteArray bytes) {
+    QString literal = "\"";
+    for (char c: bytes) {
+        uchar code = c;
+        if (code == '"' || code == '\\') literal += QString("\\") + QChar(code);
+        else if (code < 0x20 || code >= 0x7F) literal += QString("\\%1").arg(code, 3, 8, QChar('0'));
+        else literal += QChar(code);
+    }
+    return literal + "\"";
+}
+
+/*!
+    @name   libraryNamespace
+    @brief  由词法分析库的文件名得到命名空间名
+    @param  name 文件名（不含扩展名）
+    @return C++ 标识符
+    @attention  非字母、数字、下划线的字符替换为下划线，不能以数字开头
+*/
+static QString libraryNamespace(QString name) {
+    QString space = "";
+    for (QChar c: name) {
+        space += (c.unicode() < 0x80 && (c.isLetterOrNumber() || c == '_')) ? c : QChar('_');
+    }
+    if (space.isEmpty() || space[0].isDigit()) space.prepend("lex_");
+    return space;
+}
+
+/*!
+    @name   indentCode
+    @brief  代码整体缩进一层
+    @param  code 代码
+    @return
+    @attention  空行保持为空
+*/
+static QString indentCode(QString code) {
+    QStringList lines = code.split('\n');
+    for (QString &line: lines) {
+        if (!line.isEmpty()) line.prepend('\t');
+    }
+    return lines.join('\n');
+}
 
 TaskOneWidget::TaskOneWidget(QWidget *parent) :
     QWidget(parent),
@@ -45,9 +262,9 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
     ui->tabWidget->setTabText(4, "词法分析结果");
     ui->tabWidget->setCurrentIndex(0);
 
-    ui->nfaTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    ui->dfaTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    ui->miniDfaTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->nfaTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->dfaTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    ui->miniDfaTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
     ui->resultTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     ui->textEdit->setPlaceholderText(QString("请在此处填充正则表达式，以下划线_开头的标识符会展示NFA、DFA、最小化DFA以及词法分析程序函数，如：\n_identifier=letter(letter|digit)*\ndigit=[0-9]\nletter=[a-zA-Z]"));
@@ -74,20 +291,44 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
         id2nfa.clear();
         id2dfa.clear();
         id2minidfa.clear();
+        id2derivdfa.clear();
+        clearModels();
         ui->comboBox->clear();
+        bool keepMapping = !ui->productionCheckBox->isChecked();
 
         QStringList lines = ui->textEdit->toPlainText().split('\n', QString::SkipEmptyParts);
-        lines = regexListPreprocessing(lines);  // 预处理正则表达式
+        lines = regexListPreprocessing(lines, ui->utf8CheckBox->isChecked());  // 预处理正则表达式
 
         // 构造键值对：键为等号左侧，值为等号右侧
         QHash<QString, QString> reHash = buildReHash(lines);
 
+        // 词法模式标注（如 <COMMENT>_commentEnd>INITIAL）从名称中去除，单独记录
+        tokenModes.clear();
+        nextMode.clear();
+        buildModeHash(reHash, tokenModes, nextMode);
+        QStringList modeList = Lexer::modesOf(tokenModes.keys(), tokenModes);
+        for (QString mode: nextMode.values()) {
+            if (!modeList.contains(mode)) {
+                QMessageBox::warning(this, "警告", "未定义的词法模式：" + mode);
+                return;
+            }
+        }
+
+        // 集合运算定义（如 _identifier=word-_keyword）单独由乘积构造处理，不参与展开
+        QHash<QString, QStringList> setHash = buildSetHash(reHash);
+        for (QString key: setHash.keys()) {
+            reHash.remove(key);
+        }
+        QHash<QString, QString> fullHash = expandRegex(reHash);
+
         // 合并正则表达式
         reHash = combineRegex(reHash);
 
+        RegexSimplifier simplifier;     // 各单词共用一张项表，相同的子表达式只化简一次
         for (QString key: reHash.keys()) {
             reHash[key] = addConnectOp(reHash[key]);    // 正则添加连接符
             reHash[key] = regexToPostFix(reHash[key]);  // 转换为后缀表达式并存储
+            if (ui->simplifyCheckBox->isChecked()) reHash[key] = simplifier.simplify(reHash[key]);
         }
 
         // 保存正则表达式映射并修改combobox样式
@@ -95,72 +336,163 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
         for (QString key: id2str.keys()) {
             ui->comboBox->addItem(key);
         }
+        for (QString key: setHash.keys()) {
+            if (key[0] == '_') ui->comboBox->addItem(key.right(key.size() - 1));
+        }
 
-        // 正则表达式转NFA
+        // 各单词的 正则表达式 → NFA → DFA → 最小化DFA 互不相关，在线程池中并行构造
+        QElapsedTimer timer;
+        timer.start();
+        QStringList keys = id2str.keys();
+        std::sort(keys.begin(), keys.end());
+        QList<QPair<QString, QString>> regexList;
+        for (QString key: keys) {
+            regexList.append(qMakePair(key, id2str[key]));
+        }
+        QList<TokenAutomata> automataList = QtConcurrent::blockingMapped(regexList, TokenAutomataBuilder(ui->literalTrieCheckBox->isChecked(), keepMapping));
+        AutomataCache::prune();
+
+        // 按名称顺序合并结果，出错时报告第一个出错的单词
+        int cacheHitNum = 0;
+        for (TokenAutomata automata: automataList) {
+            if (!automata.error.isEmpty()) {
+                QMessageBox::warning(this, "警告", automata.error);
+                return;
+            }
+            if (automata.cached) cacheHitNum++;
+            if (automata.nfa.stateNum > 0) id2nfa[automata.key] = automata.nfa;
+            id2dfa[automata.key] = automata.dfa;
+            id2minidfa[automata.key] = automata.minidfa;
+        }
+        qint64 thompsonTime = timer.elapsed();
+
+        // 导数法直接构造 DFA，用于与 Thompson → 子集构造 → 最小化 对比，只在勾选时构造
+        qint64 derivativeTime = 0;
+        if (ui->derivativeCheckBox->isChecked()) {
+            timer.restart();
+            try {
+                for (QString key: id2str.keys()) {
+                    DFA derivdfa;
+                    derivdfa.fromDerivative(id2str[key]);
+                    id2derivdfa[key] = derivdfa;
+                }
+            } catch (QString e) {
+                QMessageBox::warning(this, "警告", e);
+                return;
+            }
+            derivativeTime = timer.elapsed();
+        }
+
+        // 集合运算定义：对最小化 DFA 做乘积构造后再最小化
         try {
-            for (QString key: id2str.keys()) {
-                NFA nfa;
-                nfa.fromRegex(id2str[key]);
-                id2nfa[key] = nfa;
+            for (QString key: setHash.keys()) {
+                if (key[0] != '_') continue;
+                QString name = key.right(key.size() - 1);
+                DFA dfa = buildSetDFA(key, fullHash, setHash, QSet<QString>());
+                DFA minidfa;
+                minidfa.fromDFA(dfa, keepMapping);
+                id2dfa[name] = dfa;
+                id2minidfa[name] = minidfa;
             }
         } catch (QString e) {
             QMessageBox::warning(this, "警告", e);
             return;
-        } catch (QException e) {
-            QMessageBox::warning(this, "警告", "未知错误");
-            return;
         }
 
-        // NFA 转 DFA
-        try {
-            for (QString key: id2nfa.keys()) {
-                DFA dfa;
-                dfa.fromNFA(id2nfa[key]);
-                id2dfa[key] = dfa;
+        // 生成的代码按字节读取源程序，非 Latin-1 字符须先展开为 UTF-8 字节序列
+        if (!ui->utf8CheckBox->isChecked()) {
+            QStringList names = id2minidfa.keys();
+            std::sort(names.begin(), names.end());
+            for (QString key: names) {
+                QChar c = nonLatin1Char(id2minidfa[key]);
+                if (!c.isNull()) {
+                    QMessageBox::warning(this, "警告", QString("单词 %1 含非 Latin-1 字符 %2，无法生成按字节读取的 C++ 字符字面量，请勾选 UTF-8 字节自动机").arg(key).arg(c));
+                    id2minidfa.clear();     // 切换代码形式时不再用这些 DFA 生成代码
+                    return;
+                }
             }
-        } catch (QException e) {
-            QMessageBox::warning(this, "警告", "未知错误");
-            return;
         }
 
-        // DFA 最小化
-        try {
-            for (QString key: id2dfa.keys()) {
-                DFA minidfa;
-                minidfa.fromDFA(id2dfa[key]);
-                id2minidfa[key] = minidfa;
-            }
-        } catch (QException e) {
-            QMessageBox::warning(this, "警告", "未知错误");
-            return;
+        int miniStateNum = 0, derivStateNum = 0;
+        for (QString key: id2str.keys()) {
+            miniStateNum += id2minidfa[key].stateNum;
+            if (id2derivdfa.contains(key)) derivStateNum += id2derivdfa[key].stateNum;
         }
 
+        // 热状态重排：以待分词源代码为样例统计访问次数，没有样例时按广度优先顺序
+        if (ui->hotStateCheckBox->isChecked()) {
+            QHash<QString, QVector<qint64>> visits;
+            if (!ui->srcEdit->toPlainText().isEmpty()) {
+                buildLexer();
+                QString error;
+                visits = lexer.profile(ui->srcEdit->toPlainText(), &error);
+                if (!error.isEmpty()) {
+                    QMessageBox::warning(this, "警告", "样例分词失败，热状态统计只包含出错位置之前的部分：" + error);
+                }
+            }
+            for (QString key: id2minidfa.keys()) {
+                if (visits.contains(key)) {
+                    id2minidfa[key].renumber(id2minidfa[key].frequencyOrder(visits[key]));
+                } else {
+                    id2minidfa[key].renumber(id2minidfa[key].bfsOrder());
+                }
+            }
+        }
 
         // 生成词法分析程序
-        showNFA(id2nfa[ui->comboBox->currentText()]);
-        showDFA(id2dfa[ui->comboBox->currentText()]);
-        showMiniDFA(id2minidfa[ui->comboBox->currentText()]);
+        ensureMapping(ui->comboBox->currentText());
+        showNFA(ui->comboBox->currentText());
+        showDFA(ui->comboBox->currentText());
+        showMiniDFA(ui->comboBox->currentText());
 
         QString analysisCode = this->toCode();
         ui->codeView->setText(analysisCode);
+        tokenSpec = lines.join('\n') + QString("\nutf8=%1 simplify=%2")
+                .arg(ui->utf8CheckBox->isChecked()).arg(ui->simplifyCheckBox->isChecked());
+        buildLexer();
 
-        QMessageBox::information(this, "提示", "正则表达式分析完成");
+        QString derivativeInfo;
+        if (ui->derivativeCheckBox->isChecked()) {
+            derivativeInfo = QString("导数构造：%1 ms，DFA状态数 %2\n").arg(derivativeTime).arg(derivStateNum);
+        }
+        QMessageBox::information(this, "提示", "正则表达式分析完成\n"
+                                 + QString("Thompson构造：%1 ms，最小化DFA状态数 %2\n").arg(thompsonTime).arg(miniStateNum)
+                                 + derivativeInfo
+                                 + QString("自动机缓存命中：%1/%2").arg(cacheHitNum).arg(automataList.size()));
     });
 
+    // 切换生成代码的形式
+    auto regenerateCode = [&]() {
+        if (id2minidfa.empty()) return;
+        ui->codeView->setText(this->toCode());
+    };
+    connect(ui->tableCheckBox, &QCheckBox::toggled, this, regenerateCode);
+    connect(ui->spanCheckBox, &QCheckBox::toggled, this, regenerateCode);
+    connect(ui->constexprCheckBox, &QCheckBox::toggled, this, regenerateCode);
+
+    // 切换关键字、字面量的识别方式
+    auto rebuildLexer = [&]() {
+        if (id2minidfa.empty()) return;
+        ui->codeView->setText(this->toCode());
+        buildLexer();
+    };
+    connect(ui->hashKeywordCheckBox, &QCheckBox::toggled, this, rebuildLexer);
+    connect(ui->literalTrieCheckBox, &QCheckBox::toggled, this, rebuildLexer);
+    connect(ui->linearCheckBox, &QCheckBox::toggled, this, rebuildLexer);
+
     // 切换正则表达式
     connect(ui->comboBox, static_cast<void (QComboBox::*)(const QString&)>(&QComboBox::currentIndexChanged),
             this, [&](const QString& text) {
         if (text.size() == 0 || text == "") return;
 
-        // 获取对应的nfa、dfa、最小化dfa
-        NFA nfa = id2nfa[text];
-        DFA dfa = id2dfa[text];
-        DFA miniDfa = id2minidfa[text];
-
-        // 渲染
-        this->showNFA(nfa);
-        this->showDFA(dfa);
-        this->showMiniDFA(miniDfa);
+        // 渲染对应的nfa、dfa、最小化dfa
+        ensureMapping(text);
+        this->showNFA(text);
+        this->showDFA(text);
+        this->showMiniDFA(text);
+        if (!id2str.contains(text) && id2minidfa.contains(text)) {
+            QMessageBox::information(this, "提示", "集合定义无NFA，只展示乘积构造得到的DFA与最小化DFA", QMessageBox::Yes);
+        }
     });
 
     // 保存正则表达式文件
@@ -177,6 +509,85 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
         }
     });
 
+    // 导出自动机镜像
+    connect(ui->saveImageButton, &QPushButton::clicked, this, [&]() {
+        if (lexer.names.empty()) {
+            QMessageBox::warning(this, "提示", "请先进行正则表达式分析！", QMessageBox::Yes);
+            return;
+        }
+        QString fileName = QFileDialog::getSaveFileName(this, "导出自动机镜像", "scanner.dfa");
+        if (fileName.isEmpty()) return;
+        if (DFAImage::save(fileName, lexer.names, lexer.tables, lexer.utf8)) {
+            QMessageBox::information(this, "提示", "文件保存为：" + fileName + "成功！", QMessageBox::Yes);
+        } else {
+            QMessageBox::warning(this, "提示", "文件保存失败！", QMessageBox::Yes);
+        }
+    });
+
+    // 导出词法分析库：头文件与源文件，由其他程序直接链接
+    connect(ui->exportLibraryButton, &QPushButton::clicked, this, [&]() {
+        if (id2minidfa.empty()) {
+            QMessageBox::warning(this, "提示", "请先进行正则表达式分析！", QMessageBox::Yes);
+            return;
+        }
+        QString fileName = QFileDialog::getSaveFileName(this, "导出词法分析库", "scanner.cpp");
+        if (fileName.isEmpty()) return;
+        QFileInfo info(fileName);
+        QString baseName = info.path() + "/" + info.completeBaseName();
+        QString header;
+        QString source = this->toCode(&header, info.completeBaseName());
+        QFile headerFile(baseName + ".h");
+        QFile sourceFile(baseName + ".cpp");
+        if (!headerFile.open(QIODevice::WriteOnly | QIODevice::Text) || !sourceFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QMessageBox::warning(this, "提示", "文件保存失败！", QMessageBox::Yes);
+            return;
+        }
+        QTextStream headerOut(&headerFile);
+        headerOut.setCodec("UTF-8");
+        headerOut << header;
+        headerOut << flush;
+        QTextStream sourceOut(&sourceFile);
+        sourceOut.setCodec("UTF-8");
+        sourceOut << source;
+        sourceOut << flush;
+        QMessageBox::information(this, "提示", "文件保存为：" + baseName + ".h、" + baseName + ".cpp成功！", QMessageBox::Yes);
+    });
+
+    // 导出批量分词程序：多线程处理命令行给出的文件列表
+    connect(ui->exportBatchButton, &QPushButton::clicked, this, [&]() {
+        if (id2minidfa.empty()) {
+            QMessageBox::warning(this, "提示", "请先进行正则表达式分析！", QMessageBox::Yes);
+            return;
+        }
+        QString fileName = QFileDialog::getSaveFileName(this, "导出批量分词程序", "batch_lexer.cpp");
+        if (fileName.isEmpty()) return;
+        QFile file(fileName);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream out(&file);
+            out.setCodec("UTF-8");
+            out << this->toBatchCode(QFileInfo(fileName).completeBaseName());
+            out << flush;
+            file.close();
+            QMessageBox::information(this, "提示", "文件保存为：" + fileName + "成功！", QMessageBox::Yes);
+        } else {
+            QMessageBox::warning(this, "提示", "文件保存失败！", QMessageBox::Yes);
+        }
+    });
+
+    // 载入自动机镜像：直接用于进程内分词，无需重新构造自动机
+    connect(ui->loadImageButton, &QPushButton::clicked, this, [&]() {
+        QString fileName = QFileDialog::getOpenFileName(this, "载入自动机镜像");
+        if (fileName.isEmpty()) return;
+        lexer.clear();      // lexer 可能引用旧镜像的映射内存
+        if (!image.load(fileName)) {
+            QMessageBox::warning(this, "提示", image.error, QMessageBox::Yes);
+            return;
+        }
+        lexer.build(image);
+        ui->inProcessCheckBox->setChecked(true);
+        QMessageBox::information(this, "提示", QString("已载入 %1 个单词的自动机").arg(image.names.size()), QMessageBox::Yes);
+    });
+
     // 上传源程序
     connect(ui->uploadCodeButton, &QPushButton::clicked, this, [&]() {
         QString fileName = QFileDialog::getOpenFileName(this, "上传源程序");
@@ -192,6 +603,102 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
         }
     });
 
+    // 批量分词：目录下的全部文件在线程池中进程内分词，单词流写入“源文件.lex”；
+    // 分词期间界面保持响应，会修改 lexer 的按钮在结束前禁用
+    connect(ui->batchLexButton, &QPushButton::clicked, this, [&]() {
+        if (lexer.names.empty()) {
+            QMessageBox::warning(this, "提示", "请先进行正则表达式分析！", QMessageBox::Yes);
+            return;
+        }
+        QString dirName = QFileDialog::getExistingDirectory(this, "选择待分词目录");
+        if (dirName.isEmpty()) return;
+        QStringList fileNames = sourceFiles(dirName);
+
+        QElapsedTimer timer;
+        timer.start();
+        lexer.linear = ui->linearCheckBox->isChecked();
+        bool interleave = ui->interleaveCheckBox->isChecked();
+        setLexerBusy(true);
+        QFutureWatcher<QStringList> *watcher = new QFutureWatcher<QStringList>(this);
+        connect(watcher, &QFutureWatcher<QStringList>::finished, this, [this, watcher, fileNames, interleave, timer]() {
+            QStringList errors;
+            for (QStringList result: watcher->future().results()) {
+                errors.append(result);
+            }
+            watcher->deleteLater();
+            QString message = QString("共 %1 个文件，失败 %2 个，用时 %3 ms").arg(fileNames.size()).arg(errors.size()).arg(timer.elapsed());
+            QString errorList = errors.empty() ? QString() : "\n" + errors.mid(0, 10).join("\n");
+            if (!interleave) {
+                setLexerBusy(false);
+                QMessageBox::information(this, "提示", message + errorList, QMessageBox::Yes);
+                return;
+            }
+
+            // 单流与交错分词的对比耗时较长，同样在后台运行，结束后再一起报告
+            QFutureWatcher<QString> *benchmark = new QFutureWatcher<QString>(this);
+            connect(benchmark, &QFutureWatcher<QString>::finished, this, [this, benchmark, message, errorList]() {
+                QString result = benchmark->result();
+                benchmark->deleteLater();
+                setLexerBusy(false);
+                QMessageBox::information(this, "提示", message + "\n" + result + errorList, QMessageBox::Yes);
+            });
+            benchmark->setFuture(QtConcurrent::run(this, &TaskOneWidget::benchmarkInterleave, fileNames));
+        });
+        watcher->setFuture(lexer.lexFiles(fileNames, interleave));
+    });
+
+    // 按单词搜索：当前选中单词的模式在目录下全部文件中的非锚定匹配
+    connect(ui->searchButton, &QPushButton::clicked, this, [&]() {
+        QString key = ui->comboBox->currentText();
+        if (!id2minidfa.contains(key)) {
+            QMessageBox::warning(this, "提示", "请先进行正则表达式分析并选择单词！", QMessageBox::Yes);
+            return;
+        }
+        QString dirName = QFileDialog::getExistingDirectory(this, "选择搜索目录");
+        if (dirName.isEmpty()) return;
+        QStringList fileNames = sourceFiles(dirName);
+
+        QElapsedTimer timer;
+        timer.start();
+        QSharedPointer<Searcher> searcher(new Searcher);    // 由结束回调持有，搜索期间一直有效
+        searcher->build(id2minidfa[key], lexer.utf8);
+        qint64 buildTime = timer.elapsed();
+        timer.restart();
+
+        // 在线程池中搜索，界面保持响应，结束前禁用搜索按钮
+        ui->searchButton->setEnabled(false);
+        QFutureWatcher<Searcher::FileResult> *watcher = new QFutureWatcher<Searcher::FileResult>(this);
+        connect(watcher, &QFutureWatcher<Searcher::FileResult>::finished, this,
+                [this, watcher, searcher, fileNames, dirName, buildTime, timer]() {
+            QStringList errors;
+            QList<SearchMatch> matches = Searcher::collect(watcher->future(), &errors);
+            qint64 searchTime = timer.elapsed();
+            watcher->deleteLater();
+            ui->searchButton->setEnabled(true);
+
+            int rows = qMin(matches.size(), MAX_SEARCH_ROWS);
+            ui->resultTableWidget->clear();
+            ui->resultTableWidget->setRowCount(rows);
+            ui->resultTableWidget->setColumnCount(4);
+            ui->resultTableWidget->setHorizontalHeaderLabels(QStringList() << "文件" << "行" << "偏移" << "单词");
+            for (int i = 0; i < rows; i++) {
+                ui->resultTableWidget->setItem(i, 0, new QTableWidgetItem(QDir(dirName).relativeFilePath(matches[i].fileName)));
+                ui->resultTableWidget->setItem(i, 1, new QTableWidgetItem(QString::number(matches[i].line)));
+                ui->resultTableWidget->setItem(i, 2, new QTableWidgetItem(QString::number(matches[i].offset)));
+                ui->resultTableWidget->setItem(i, 3, new QTableWidgetItem(matches[i].text));
+            }
+            ui->resultTableWidget->resizeColumnsToContents();
+            ui->tabWidget->setCurrentIndex(4);
+
+            QString message = QString("共 %1 个文件，匹配 %2 处，构造搜索自动机 %3 ms，搜索 %4 ms")
+                    .arg(fileNames.size()).arg(matches.size()).arg(buildTime).arg(searchTime);
+            if (matches.size() > rows) message += QString("\n只显示前 %1 处").arg(rows);
+            if (!errors.empty()) message += "\n" + errors.mid(0, 10).join("\n");
+            QMessageBox::information(this, "提示", message, QMessageBox::Yes);
+        });
+        watcher->setFuture(searcher->searchFiles(fileNames));
+    });
+
     // 源代码分析
     connect(ui->lexButton, &QPushButton::clicked, this, [&]() {
         ui->resultTableWidget->clear();
@@ -199,10 +706,35 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
         ui->resultTableWidget->setRowCount(0);
         ui->resultTableWidget->setColumnCount(0);
 
+        // 进程内分词：直接使用最小化 DFA 的转移表，不再生成、编译程序
+        if (ui->inProcessCheckBox->isChecked()) {
+            QList<QPair<QString, QString>> tokens;
+            try {
+                lexer.linear = ui->linearCheckBox->isChecked();
+                tokens = lexer.lex(ui->srcEdit->toPlainText());
+            } catch (QString e) {
+                QMessageBox::warning(this, "提示", e, QMessageBox::Yes);
+                return;
+            }
+            ui->resultTableWidget->setRowCount(tokens.size());
+            ui->resultTableWidget->setColumnCount(2);
+            ui->resultTableWidget->setHorizontalHeaderLabels(QStringList() << "单词（token）" << "类型（type）");
+            for (int i = 0; i < tokens.size(); i++) {
+                // 与生成程序一致：大写开头的单词类型以单词本身作为类型
+                QString type = tokens[i].second[0].isUpper() ? tokens[i].first : tokens[i].second;
+                ui->resultTableWidget->setItem(i, 0, new QTableWidgetItem(tokens[i].first));
+                ui->resultTableWidget->setItem(i, 1, new QTableWidgetItem(type));
+            }
+            ui->resultTableWidget->resizeColumnsToContents();
+            ui->resultTableWidget->resizeRowsToContents();
+            return;
+        }
+
         QString srcFileName = QString("src.txt");
         QFile srcFile(srcFileName);
         if (srcFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&srcFile);
+            if (lexer.utf8) out.setCodec("UTF-8");  // 字节自动机按 UTF-8 字节分词
             out << ui->srcEdit->toPlainText();
             out << flush;
             srcFile.close();
@@ -210,24 +742,15 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
             QMessageBox::warning(this, "提示", "待分词源文件保存失败！", QMessageBox::Yes);
         }
 
-        QString anaFileName = QString("anslysis.cpp");
-        QFile anaFile(anaFileName);
-        if (anaFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&anaFile);
-            out << ui->codeView->toPlainText();
-            out << flush;
-            anaFile.close();
-        } else {
-            QMessageBox::warning(this, "提示", "词法分析程序保存失败！", QMessageBox::Yes);
+        // 单词定义不变时直接运行缓存的程序，不再编译
+        QString error;
+        QString program = LexerCache::executable(codeSpec(), ui->codeView->toPlainText(), "anslysis.cpp", &error);
+        if (program.isEmpty()) {
+            QMessageBox::warning(this, "提示", error, QMessageBox::Yes);
+            return;
         }
-
-//        QString compileStr = "g++ -std=c++11 " + anaFileName + " -o analysis";
         QProcess process;
-        process.start("g++", QStringList() << anaFileName << "-o" << "analysis");
-        if (!process.waitForFinished()) {
-            QMessageBox::warning(this, "提示", "编译失败!", QMessageBox::Yes);
-        }
-        process.start("./analysis");
+        process.start(QFileInfo(program).absoluteFilePath());
         if (!process.waitForFinished()) {
             QMessageBox::warning(this, "提示", "运行失败!", QMessageBox::Yes);
         }
@@ -288,225 +811,1027 @@ TaskOneWidget::TaskOneWidget(QWidget *parent) :
 }
 
 TaskOneWidget::~TaskOneWidget() {
+    QThreadPool::globalInstance()->waitForDone();   // 批量分词的工作线程引用 lexer
     delete ui;
 }
 
 /*!
-    @name   showNFA
-    @brief  展示 NFA
-    @param  nfa
+    @name   nfaOf
+    @brief  获取用于展示的 NFA
+    @param  key 正则表达式名称
+    @return NFA
+    @attention  从缓存读取的单词没有 NFA，第一次展示时再由后缀正则表达式构造
+*/
+NFA &TaskOneWidget::nfaOf(QString key) {
+    if (!id2nfa.contains(key) && id2str.contains(key)) {
+        NFA nfa;
+        nfa.fromRegex(id2str[key]);
+        id2nfa[key] = nfa;
+    }
+    return id2nfa[key];
+}
+
+/*!
+    @name   ensureMapping
+    @brief  按需恢复状态来源
+    @param  key 正则表达式名称
+    @return
+    @attention  生产模式下构造完成后不保留 mapping，展示前由优化后的 NFA 与最小化前的 DFA 重新计算
+*/
+void TaskOneWidget::ensureMapping(QString key) {
+    if (id2dfa.contains(key) && id2dfa[key].mapping.empty() && id2str.contains(key)) {
+        NFA nfa = nfaOf(key);
+        nfa.optimize();     // 子集构造使用的是优化后的 NFA
+        id2dfa[key].mapping = id2dfa[key].mappingFromNFA(nfa);
+    }
+    if (id2minidfa.contains(key) && id2minidfa[key].mapping.empty() && id2dfa.contains(key)) {
+        id2minidfa[key].mapping = id2minidfa[key].mappingFromDFA(id2dfa[key]);
+    }
+}
+
+/*!
+    @name   setLexerBusy
+    @brief  后台批量分词期间禁用会修改 lexer 的按钮与选项
+    @param  busy 是否正在分词
+    @return
+    @attention  工作线程只读共享 lexer，结束前不能重新构造、载入镜像或修改匹配策略
+*/
+void TaskOneWidget::setLexerBusy(bool busy) {
+    ui->ReButton->setEnabled(!busy);
+    ui->loadImageButton->setEnabled(!busy);
+    ui->batchLexButton->setEnabled(!busy);
+    ui->lexButton->setEnabled(!busy);
+    ui->codeOptionWidget->setEnabled(!busy);
+}
+
+/*!
+    @name   buildLexer
+    @brief  按界面选项由最小化 DFA 构造进程内词法分析器
+    @param
     @return
     @attention
 */
-void TaskOneWidget::showNFA(NFA& nfa) {
-    ui->nfaTableWidget->clear();
-    ui->nfaTableWidget->setHorizontalHeaderLabels(QStringList());
-    ui->nfaTableWidget->setRowCount(0);
-    ui->nfaTableWidget->setColumnCount(0);
-
-    ui->nfaTableWidget->setRowCount(nfa.stateNum);
-    ui->nfaTableWidget->setColumnCount(nfa.stateSet.size());
-    QStringList strListColumnHander;
-    for (QString item : nfa.stateSet) {
-        strListColumnHander << tr(item.toStdString().c_str());
-    }
-    ui->nfaTableWidget->setHorizontalHeaderLabels(strListColumnHander);
-    QStringList strListRowHander;
-    for (int i = 0; i < nfa.stateNum; i++) {
-        strListRowHander << tr(QString::number(i).toStdString().c_str());
-    }
-    ui->nfaTableWidget->setVerticalHeaderLabels(strListRowHander);
-
-    for (int i = 0; i < nfa.stateNum; i++) {
-        int j = 0;
-        for (QString stateChange: nfa.stateSet) {
-            QString itemString = "";
-            for (int k = 0; k < nfa.stateNum; k++) {
-                if (nfa.G[i][k] == stateChange) {
-                    itemString += QString::number(k);
-                    itemString += ",";
-                }
+void TaskOneWidget::buildLexer() {
+    lexer.tokenModes = tokenModes;
+    lexer.nextMode = nextMode;
+    lexer.build(id2minidfa, ui->utf8CheckBox->isChecked(),
+                ui->hashKeywordCheckBox->isChecked(), ui->literalTrieCheckBox->isChecked());
+}
+
+/*!
+    @name   benchmarkInterleave
+    @brief  在内存中比较单流分词与多流交错分词的耗时
+    @param  fileNames 源文件列表
+    @return 比较结果
+    @attention  单线程运行，不计读写文件的时间，同时检查两种方式的结果是否一致；
+                耗时与批量分词相当，由线程池中的任务调用，只读 lexer
+*/
+QString TaskOneWidget::benchmarkInterleave(QStringList fileNames) {
+    QVector<QString> srcs;
+    for (QString fileName: fileNames) {
+        QString src;
+        if (Lexer::readSource(fileName, src)) srcs.append(lexer.machineString(src));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QVector<TokenSpan>> single(srcs.size());
+    for (int i = 0; i < srcs.size(); i++) {
+        try {
+            single[i] = lexer.scan(srcs[i]);
+        } catch (QString e) {
+            // 出错的源程序结果为空
+        }
+    }
+    qint64 singleTime = timer.nsecsElapsed();
+
+    timer.restart();
+    QStringList errors;
+    QVector<QVector<TokenSpan>> batch = lexer.scanBatch(srcs, errors);
+    qint64 batchTime = timer.nsecsElapsed();
+
+    // 出错的源程序只比较是否都出错
+    int mismatch = 0;
+    for (int i = 0; i < srcs.size(); i++) {
+        if (!errors[i].isEmpty()) {
+            if (!single[i].empty()) mismatch++;
+            continue;
+        }
+        if (single[i].size() != batch[i].size()) {
+            mismatch++;
+            continue;
+        }
+        for (int j = 0; j < single[i].size(); j++) {
+            if (single[i][j].kind != batch[i][j].kind || single[i][j].offset != batch[i][j].offset
+                    || single[i][j].length != batch[i][j].length) {
+                mismatch++;
+                break;
             }
-            ui->nfaTableWidget->setItem(i, j, new QTableWidgetItem(itemString.left(itemString.size() - 1)));
-            j++;
         }
     }
+    return QString("单流分词：%1 ms，%2 路交错分词：%3 ms，结果不一致的文件 %4 个")
+            .arg(singleTime / 1e6, 0, 'f', 2).arg(DFATable::MAX_LANES).arg(batchTime / 1e6, 0, 'f', 2).arg(mismatch);
+}
 
-    // 添加始态、终态颜色
-    QTableWidgetItem *beginItem = ui->nfaTableWidget->verticalHeaderItem(nfa.startState);
-    QTableWidgetItem *endItem = ui->nfaTableWidget->verticalHeaderItem(nfa.endState);
-    if (beginItem) beginItem->setTextColor(QColor(0, 255, 0));
-    if (endItem) endItem->setTextColor(QColor(255, 0, 0));
-
-    ui->nfaTableWidget->resizeColumnsToContents();
-    ui->nfaTableWidget->resizeRowsToContents();
+/*!
+    @name   showNFA
+    @brief  展示 NFA
+    @param  key 正则表达式名称
+    @return
+    @attention  单元格由模型按需计算，模型按名称缓存，切换回来时不再重复计算；
+                不按内容调整列宽，否则视图会让模型算出全部单元格；
+                集合运算定义由乘积构造得到，没有正则表达式与 NFA，清空视图
+*/
+void TaskOneWidget::showNFA(QString key) {
+    if (!id2str.contains(key)) {
+        ui->nfaTableView->setModel(nullptr);
+        return;
+    }
+    if (!nfaModels.contains(key)) {
+        nfaModels[key] = new NFATableModel(nfaOf(key), this);
+    }
+    ui->nfaTableView->setModel(nfaModels[key]);
 }
 
 /*!
     @name   showDFA
     @brief  展示 DFA
-    @param  dfa
+    @param  key 正则表达式名称
     @return
     @attention
 */
-void TaskOneWidget::showDFA(DFA& dfa) {
-    ui->dfaTableWidget->clear();
-    ui->dfaTableWidget->setHorizontalHeaderLabels(QStringList());
-    ui->dfaTableWidget->setRowCount(0);
-    ui->dfaTableWidget->setColumnCount(0);
+void TaskOneWidget::showDFA(QString key) {
+    if (!dfaModels.contains(key)) {
+        dfaModels[key] = new DFATableModel(id2dfa[key], this);
+    }
+    ui->dfaTableView->setModel(dfaModels[key]);
+}
+
+/*!
+    @name   showMiniDFA
+    @brief  展示最小化的 DFA
+    @param  key 正则表达式名称
+    @return
+    @attention
+*/
+void TaskOneWidget::showMiniDFA(QString key) {
+    if (!miniDfaModels.contains(key)) {
+        miniDfaModels[key] = new DFATableModel(id2minidfa[key], this);
+    }
+    ui->miniDfaTableView->setModel(miniDfaModels[key]);
+}
+
+/*!
+    @name   clearModels
+    @brief  清空缓存的状态转移表模型
+    @param
+    @return
+    @attention  自动机重新构造后调用
+*/
+void TaskOneWidget::clearModels() {
+    ui->nfaTableView->setModel(nullptr);
+    ui->dfaTableView->setModel(nullptr);
+    ui->miniDfaTableView->setModel(nullptr);
+    qDeleteAll(nfaModels);
+    qDeleteAll(dfaModels);
+    qDeleteAll(miniDfaModels);
+    nfaModels.clear();
+    dfaModels.clear();
+    miniDfaModels.clear();
+}
+
+/*!
+    @name   buildSetDFA
+    @brief  集合运算定义构造 DFA：从左到右依次对操作数的最小化 DFA 做乘积构造
+    @param  name 集合运算定义的名称
+    @param  fullHash 展开后的全部正则表达式
+    @param  setHash 全部集合运算定义
+    @param  visiting 正在构造的名称，用于发现循环引用
+    @return 乘积 DFA（未最小化）
+    @attention
+*/
+DFA TaskOneWidget::buildSetDFA(QString name, QHash<QString, QString> &fullHash,
+                               QHash<QString, QStringList> &setHash, QSet<QString> visiting) {
+    if (visiting.contains(name)) {
+        throw QString("集合运算定义存在循环引用：") + name;
+    }
+    visiting.insert(name);
+
+    QStringList setList = setHash[name];
+    DFA result = buildOperandDFA(setList[0], fullHash, setHash, visiting);
+    for (int i = 1; i + 1 < setList.size(); i += 2) {
+        DFA operand = buildOperandDFA(setList[i + 1], fullHash, setHash, visiting);
+        DFA product;
+        product.fromProduct(result, operand, setList[i][0]);
+        if (i + 2 >= setList.size()) return product;
+        result.clear();
+        result.fromDFA(product);
+    }
+    return result;
+}
+
+/*!
+    @name   buildOperandDFA
+    @brief  集合运算操作数构造最小化 DFA
+    @param  name 操作数名称
+    @param  fullHash 展开后的全部正则表达式
+    @param  setHash 全部集合运算定义
+    @param  visiting 正在构造的名称，用于发现循环引用
+    @return 最小化 DFA
+    @attention
+*/
+DFA TaskOneWidget::buildOperandDFA(QString name, QHash<QString, QString> &fullHash,
+                                   QHash<QString, QStringList> &setHash, QSet<QString> visiting) {
+    DFA dfa;
+    if (setHash.contains(name)) {
+        dfa = buildSetDFA(name, fullHash, setHash, visiting);
+    } else {
+        NFA nfa;
+        QString re = regexToPostFix(addConnectOp(fullHash[name]));
+        if (ui->simplifyCheckBox->isChecked()) re = RegexSimplifier().simplify(re);
+        nfa.fromRegex(re);
+        nfa.optimize();
+        dfa.fromNFA(nfa);
+    }
+    DFA minidfa;
+    minidfa.fromDFA(dfa);
+    return minidfa;
+}
+
+/*!
+    @name   toTableCode
+    @brief  生成表驱动的单词识别函数
+    @param  dfaKey 单词名称
+    @param  minidfa 最小化 DFA
+    @param  tables 转移表等常量追加到这里
+    @return 单词识别函数代码
+    @attention  使用 minidfa.table：字符先映射到字符类，再查 state * classNum + class 处的连续转移表
+*/
+QString TaskOneWidget::toTableCode(QString dfaKey, DFA &minidfa, QString &tables) {
+    if (ui->constexprCheckBox->isChecked()) return constexprTableCode(dfaKey, minidfa, tables);
+    DFATable &table = minidfa.table;
+    QString stateType = table.stateWidth == 1 ? "unsigned char" : (table.stateWidth == 2 ? "unsigned short" : "unsigned int");
+    QString classType = table.classNum <= 0xFF ? "unsigned char" : "unsigned short";
+
+    // 字符类映射
+    tables += "static const " + classType + " class_" + dfaKey + "[256] = {";
+    for (int i = 0; i < 256; i++) {
+        if (i % 32 == 0) tables += "\n\t";
+        tables += QString::number(table.latinClass(i)) + ",";
+    }
+    tables += "\n};\n";
+
+    // 连续转移表
+    tables += "static const " + stateType + " table_" + dfaKey + "[] = {";
+    for (int i = 0; i < table.stateNum; i++) {
+        tables += "\n\t";
+        for (int cls = 0; cls < table.classNum; cls++) {
+            tables += QString::number(table.next(i, cls)) + ",";
+        }
+    }
+    tables += "\n};\n";
+
+    // 终态位图
+    tables += "static const unsigned int accept_" + dfaKey + "[] = {";
+    for (int i = 0; i < table.acceptBits.size() / int(sizeof(quint32)); i++) {
+        tables += QString::number(table.acceptWord(i)) + "u,";
+    }
+    tables += "};\n";
 
-    ui->dfaTableWidget->setRowCount(dfa.stateNum);
-    ui->dfaTableWidget->setColumnCount(dfa.changeSet.size() - (dfa.changeSet.contains("epsilon") ? 1 : 0));
+    QString code = "";
+    bool linear = ui->linearCheckBox->isChecked();
+    code += "bool check_" + dfaKey + "() {\n";
+    code += "\tint state = " + QString::number(table.startState) + ";\n";
+    code += "\tchar c;\n";
+    if (linear) code += "\tvector<unsigned long long> trail;\n";
+    code += "\twhile ((c = in.peek()) != EOF) {\n";
+    if (linear) code += failedCheckCode("failed_" + dfaKey);
+    code += "\t\tint next = table_" + dfaKey + "[state * " + QString::number(table.classNum)
+            + " + class_" + dfaKey + "[(unsigned char)c]];\n";
+    code += "\t\tif (next == " + QString::number(table.deadState) + ") break;\n";
+    code += "\t\tstate = next;\n";
+    code += "\t\tbuf += c;\n";
+    code += "\t\tin.get(c);\n";
+    code += "\t}\n";
+    code += "\tif ((accept_" + dfaKey + "[state >> 5] >> (state & 31)) & 1) {\n";
+    code += "\t\ttoken = \"" + dfaKey + "\";\n";
+    code += "\t\treturn true;\n";
+    code += "\t}\n";
+    code += linear ? "\treturn mark_failed(failed_" + dfaKey + ", trail);\n" : "\treturn false;\n";
+    code += "}\n\n";
+    return code;
+}
 
-    QStringList strListColumnHander;
-    for (QString item : dfa.changeSet) {
-        if (item == "epsilon") continue;
-        strListColumnHander << tr(item.toStdString().c_str());
+/*!
+    @name   constexprTableCode
+    @brief  生成编译期常量转移表及调用模板驱动的单词识别函数
+    @param  dfaKey 单词名称
+    @param  minidfa 最小化 DFA
+    @param  tables 转移表等常量追加到这里
+    @return 单词识别函数代码
+    @attention  字符类映射、连续转移表、终态位图均为 constexpr array，不需要运行时初始化；
+                状态类型、字符类数、始态与死状态作为 run_dfa 的模板参数，编译器可以内联并折叠常量
+*/
+QString TaskOneWidget::constexprTableCode(QString dfaKey, DFA &minidfa, QString &tables) {
+    DFATable &table = minidfa.table;
+    QString stateType = table.stateWidth == 1 ? "unsigned char" : (table.stateWidth == 2 ? "unsigned short" : "unsigned int");
+    QString classType = table.classNum <= 0xFF ? "unsigned char" : "unsigned short";
+    int words = table.acceptBits.size() / int(sizeof(quint32));
+
+    tables += "constexpr array<" + classType + ", 256> class_" + dfaKey + " = {{";
+    for (int i = 0; i < 256; i++) {
+        if (i % 32 == 0) tables += "\n\t";
+        tables += QString::number(table.latinClass(i)) + ",";
+    }
+    tables += "\n}};\n";
+
+    tables += "constexpr array<" + stateType + ", " + QString::number(table.stateNum * table.classNum)
+            + "> table_" + dfaKey + " = {{";
+    for (int i = 0; i < table.stateNum; i++) {
+        tables += "\n\t";
+        for (int cls = 0; cls < table.classNum; cls++) {
+            tables += QString::number(table.next(i, cls)) + ",";
+        }
     }
-    ui->dfaTableWidget->setHorizontalHeaderLabels(strListColumnHander);
+    tables += "\n}};\n";
 
-    QStringList strListRowHander;
-    for (int i = 0; i < dfa.stateNum; i++) {
-        strListRowHander << tr(QString::number(i).toStdString().c_str());
+    tables += "constexpr array<unsigned int, " + QString::number(words) + "> accept_" + dfaKey + " = {{";
+    for (int i = 0; i < words; i++) {
+        tables += QString::number(table.acceptWord(i)) + "u,";
     }
-    ui->dfaTableWidget->setVerticalHeaderLabels(strListRowHander);
+    tables += "}};\n";
 
-    for (int i = 0; i < dfa.stateNum; i++) {
-        if (!dfa.G.contains(i)) continue;
-        int j = 0;
-        for (QString stateChange: dfa.changeSet) {
-            if (stateChange == "epsilon") continue;
-            if (dfa.G[i].contains(stateChange)) {
+    QString code = "";
+    code += "bool check_" + dfaKey + "() {\n";
+    code += "\tif (!run_dfa<" + stateType + ", " + classType + ", " + QString::number(table.classNum) + ", "
+            + QString::number(table.startState) + ", " + QString::number(table.deadState) + ">(table_"
+            + dfaKey + ", class_" + dfaKey + ", accept_" + dfaKey;
+    if (ui->linearCheckBox->isChecked()) code += ", failed_" + dfaKey;
+    code += ")) return false;\n";
+    code += "\ttoken = \"" + dfaKey + "\";\n";
+    code += "\treturn true;\n";
+    code += "}\n\n";
+    return code;
+}
 
-                int k = dfa.G[i][stateChange];
-                QString titleTr = QString::number(k) + ":{";
-                for (int item: dfa.mapping[k]) {
-                    titleTr += QString::number(item);
-                    titleTr += ",";
-                }
-                titleTr = titleTr.left(titleTr.size() - 1);
-                titleTr += "}";
+/*!
+    @name   dfaDriverCode
+    @brief  生成编译期常量转移表共用的模板驱动
+    @param
+    @return 代码
+    @attention  每组模板参数实例化出一份专用的循环；线性时间模式下额外传入失败组合集合
+*/
+QString TaskOneWidget::dfaDriverCode() {
+    bool linear = ui->linearCheckBox->isChecked();
+    QString code = "";
+    code += "template <typename State, typename Class, int CLASSES, int START, int DEAD, size_t SIZE, size_t WORDS>\n";
+    code += "bool run_dfa(const array<State, SIZE> &table, const array<Class, 256> &cls, "
+            "const array<unsigned int, WORDS> &accept";
+    if (linear) code += ", unordered_set<unsigned long long> &failed";
+    code += ") {\n";
+    code += "\tint state = START;\n";
+    code += "\tchar c;\n";
+    if (linear) code += "\tvector<unsigned long long> trail;\n";
+    code += "\twhile ((c = in.peek()) != EOF) {\n";
+    if (linear) code += failedCheckCode("failed");
+    code += "\t\tint next = table[state * CLASSES + cls[(unsigned char)c]];\n";
+    code += "\t\tif (next == DEAD) break;\n";
+    code += "\t\tstate = next;\n";
+    code += "\t\tbuf += c;\n";
+    code += "\t\tin.get(c);\n";
+    code += "\t}\n";
+    code += "\tif ((accept[state >> 5] >> (state & 31)) & 1) return true;\n";
+    code += linear ? "\treturn mark_failed(failed, trail);\n" : "\treturn false;\n";
+    code += "}\n\n";
+    return code;
+}
 
-                ui->dfaTableWidget->setItem(i, j, new QTableWidgetItem(titleTr));
-            }
-            j++;
+/*!
+    @name   literalCode
+    @brief  生成字面量字典树及其识别函数
+    @param  literals 双数组字典树，单词编号为 lit_names 的下标
+    @param  suffix 数组与函数名的后缀，用于区分不同模式
+    @param  tables 双数组追加到这里
+    @return 识别函数代码
+    @attention
+*/
+QString TaskOneWidget::literalCode(LiteralTrie &literals, QString suffix, QString &tables) {
+    int n = literals.base.size();
+    tables += "const int LIT_SIZE" + suffix + " = " + QString::number(n) + ";\n";
+    QString baseCode = "const int lit_base" + suffix + "[LIT_SIZE" + suffix + "] = {";
+    QString checkCode = "const int lit_check" + suffix + "[LIT_SIZE" + suffix + "] = {";
+    QString tokenCode = "const int lit_token" + suffix + "[LIT_SIZE" + suffix + "] = {";
+    for (int i = 0; i < n; i++) {
+        if (i % 16 == 0) {
+            baseCode += "\n\t";
+            checkCode += "\n\t";
+            tokenCode += "\n\t";
         }
+        baseCode += QString::number(literals.base[i]) + ", ";
+        checkCode += QString::number(literals.check[i]) + ", ";
+        tokenCode += QString::number(literals.token[i]) + ", ";
     }
+    tables += baseCode + "\n};\n" + checkCode + "\n};\n" + tokenCode + "\n};\n";
+    QString function = R"(bool check_literal%1() {
+    int state = 1, len = 0, tok = -1;
+    char c;
+    while ((c = in.peek()) != EOF) {
+        int next = lit_base%1[state] + (unsigned char)c + 1;
+        if (next >= LIT_SIZE%1 || lit_check%1[next] != state) break;
+        state = next;
+        buf += c;
+        in.get(c);
+        if (lit_token%1[state] >= 0) {
+            len = buf.size();
+            tok = lit_token%1[state];
+        }
+    }
+    if (tok < 0) return false;
+    buf.resize(len);
+    token = lit_names[tok];
+    return true;
+}
 
-    // 添加始态、终态颜色
-    QTableWidgetItem *beginItem = ui->dfaTableWidget->verticalHeaderItem(dfa.startState);
-    if (beginItem) beginItem->setTextColor(QColor(0, 255, 0));
-    for (int endState: dfa.endStates) {
-        QTableWidgetItem *endItem = ui->dfaTableWidget->verticalHeaderItem(endState);
-        if (endItem) endItem->setTextColor(QColor(255, 0, 0));
+)";
+    return function.arg(suffix);
+}
+
+/*!
+    @name   failedCheckCode
+    @brief  生成线性时间模式下单词识别函数每次转移前的检查
+    @param  failedSet 失败组合集合的变量名
+    @return 代码
+    @attention  生成的识别函数不回退到上一个终态，从同一（状态, 位置）出发的结果总是相同，
+                失败过的组合再次到达时直接失败，并把本次经过的组合一并记为失败；
+                成功的匹配互不重叠，因此每个组合至多被扫描一次
+*/
+QString TaskOneWidget::failedCheckCode(QString failedSet) {
+    QString code = "";
+    code += "\t\tunsigned long long key = ((unsigned long long)(pos_cnt + buf.size()) << 32) | state;\n";
+    code += "\t\tif (" + failedSet + ".count(key)) return mark_failed(" + failedSet + ", trail);\n";
+    code += "\t\ttrail.push_back(key);\n";
+    return code;
+}
+
+/*!
+    @name   spanCode
+    @brief  生成零拷贝模式的输入与单词区间
+    @param
+    @return 代码
+    @attention  Input 与 Span 提供识别函数用到的 ifstream、string 接口（peek、get、seekg、+=、size 等），
+                识别函数的代码不变；单词只记录起点与长度，buf_err = buf 等赋值只复制两个整数
+*/
+QString TaskOneWidget::spanCode() {
+    return R"(
+struct Input {
+    string data;
+    size_t cur = 0;
+    Input(const char *name) {
+        ifstream file(name, ios::in | ios::binary);
+        data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
     }
+    int peek() const { return cur < data.size() ? (unsigned char)data[cur] : EOF; }
+    bool get(char &c) {
+        if (cur >= data.size()) return false;
+        c = data[cur++];
+        return true;
+    }
+    void unget() { cur--; }
+    void seekg(size_t pos, ios::seekdir) { cur = pos; }
+    void close() {}
+} in("src.txt");
+
+struct Span {
+    size_t off = 0, len = 0;
+    void operator+=(char) {
+        if (len == 0) off = in.cur;
+        len++;
+    }
+    const char *data() const { return in.data.data() + off; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    void clear() { len = 0; }
+    void resize(size_t n) { len = n; }
+} buf, buf_err, buf_suc;
+
+ostream &operator<<(ostream &os, const Span &s) {
+    return os.write(s.data(), s.size());
+}
 
-//    ui->dfaTableWidget->resizeColumnsToContents();
-    ui->dfaTableWidget->resizeRowsToContents();
+)";
 }
 
 /*!
-    @name   showMiniDFA
-    @brief  展示最小化的 DFA
-    @param  minidfa
-    @return
+    @name   internCode
+    @brief  生成零拷贝模式的单词编码表
+    @param
+    @return 代码
+    @attention  开放定址哈希表，表项只保存指针与长度：单词本身指向源程序，
+                单词类型名称第一次出现时复制一份（deque 扩容不移动已有元素），装填因子超过 1/2 时加倍
+*/
+QString TaskOneWidget::internCode() {
+    return R"(
+struct InternEntry {
+    const char *ptr;
+    size_t len;
+    int id;
+};
+vector<InternEntry> intern_table(64, InternEntry{nullptr, 0, 0});
+deque<string> intern_names;
+size_t intern_cnt = 0;
+
+size_t intern_hash(const char *p, size_t n) {
+    size_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void intern_place(vector<InternEntry> &table, const InternEntry &e) {
+    size_t mask = table.size() - 1;
+    size_t i = intern_hash(e.ptr, e.len) & mask;
+    while (table[i].ptr) i = (i + 1) & mask;
+    table[i] = e;
+}
+
+int intern(const char *p, size_t n, bool copy) {
+    size_t mask = intern_table.size() - 1;
+    for (size_t i = intern_hash(p, n) & mask; intern_table[i].ptr; i = (i + 1) & mask) {
+        const InternEntry &e = intern_table[i];
+        if (e.len == n && memcmp(e.ptr, p, n) == 0) return e.id;
+    }
+    if (copy) {
+        intern_names.push_back(string(p, n));
+        p = intern_names.back().data();
+    }
+    if (2 * (intern_cnt + 1) > intern_table.size()) {
+        vector<InternEntry> table(intern_table.size() * 2, InternEntry{nullptr, 0, 0});
+        for (const InternEntry &e: intern_table) {
+            if (e.ptr) intern_place(table, e);
+        }
+        intern_table.swap(table);
+    }
+    intern_cnt++;
+    intern_place(intern_table, InternEntry{p, n, idx});
+    return idx++;
+}
+
+)";
+}
+
+/*!
+    @name   libraryHeader
+    @brief  生成词法分析库的头文件
+    @param  libraryName 文件名（不含扩展名）
+    @return 代码
+    @attention  分词状态藏在 lexer::impl 中，头文件只暴露单词区间与分词接口
+*/
+QString TaskOneWidget::libraryHeader(QString libraryName) {
+    QString space = libraryNamespace(libraryName);
+    QString guard = space.toUpper() + "_H";
+    QString code = "";
+    code += "#ifndef " + guard + "\n";
+    code += "#define " + guard + "\n";
+    code += R"(
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace %1 {
+
+// 单词：text 指向 init 传入的缓冲区，不以 '\0' 结尾
+struct lex_token {
+    std::string type;       // 单词类型，无法识别时为 UNKNOWN
+    const char *text;       // 单词起点
+    size_t offset;          // 单词在缓冲区中的位置
+    size_t length;          // 单词长度
+};
+
+// 可重入的词法分析器：没有全局状态，不同对象可以在不同线程中同时分词
+class lexer {
+public:
+    enum status { error = -1, end = 0, ok = 1 };
+
+    lexer();
+    ~lexer();
+    void init(const char *data, size_t size);       // 从头开始分词，缓冲区须比分词过程存活更久
+    int next_token(lex_token &tok);                 // 识别下一个单词，返回 ok、end 或 error
+    int lex_into(std::vector<lex_token> &tokens);   // 剩余单词追加到 tokens，返回 end 或 error，无法识别的单词也追加在最后
+
+private:
+    struct impl;
+    impl *d;
+
+    lexer(const lexer &);
+    lexer &operator=(const lexer &);
+};
+
+}   // namespace %1
+
+)";
+    code = code.arg(space);
+    code += "#endif // " + guard + "\n";
+    return code;
+}
+
+/*!
+    @name   libraryInputCode
+    @brief  生成词法分析库的输入与单词区间
+    @param
+    @return 代码
+    @attention  与 spanCode 的接口相同，但不读文件、不使用全局变量：
+                Input 引用调用者的缓冲区，Span 记住所属的 Input
+*/
+QString TaskOneWidget::libraryInputCode() {
+    return R"(
+struct Input {
+    const char *data;
+    size_t size, cur;
+    Input(): data(nullptr), size(0), cur(0) {}
+    int peek() const { return cur < size ? (unsigned char)data[cur] : EOF; }
+    bool get(char &c) {
+        if (cur >= size) return false;
+        c = data[cur++];
+        return true;
+    }
+    void unget() { cur--; }
+    void seekg(size_t pos, ios::seekdir) { cur = pos; }
+};
+
+struct Span {
+    const Input *in;
+    size_t off, len;
+    Span(const Input *in = nullptr): in(in), off(0), len(0) {}
+    void operator+=(char) {
+        if (len == 0) off = in->cur;
+        len++;
+    }
+    const char *data() const { return in->data + off; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    void clear() { len = 0; }
+    void resize(size_t n) { len = n; }
+};
+
+)";
+}
+
+/*!
+    @name   libraryImplCode
+    @brief  生成词法分析库的分词状态及其成员函数
+    @param  functions 读写分词状态的函数（skipBlank、各单词的识别函数）
+    @param  failedSets 线性时间模式下各单词的失败组合集合
+    @param  linear 是否为线性时间模式
+    @return 代码，lexer::impl 的定义到 next_token 之前为止
+    @attention  程序中的全局变量成为成员，识别函数原样成为成员函数
+*/
+QString TaskOneWidget::libraryImplCode(QString functions, QStringList failedSets, bool linear) {
+    QString code = "";
+    code += "struct lexer::impl {\n";
+    code += "\tInput in;\n";
+    code += "\tSpan buf, buf_err, buf_suc;\n";
+    code += "\tstring token, token_suc;\n";
+    code += "\tsize_t read_cnt;\n";
+    if (linear) code += "\tlong long pos_cnt;\n";
+    code += "\tint mode;\n";
+    for (QString item: failedSets) {
+        code += "\tunordered_set<unsigned long long> " + item + ";\n";
+    }
+    code += "\n";
+    code += "\timpl(): buf(&in), buf_err(&in), buf_suc(&in), read_cnt(0), ";
+    if (linear) code += "pos_cnt(0), ";
+    code += "mode(0) {}\n\n";
+
+    code += "\tvoid reset(const char *data, size_t size) {\n";
+    code += "\t\tin.data = data;\n";
+    code += "\t\tin.size = size;\n";
+    code += "\t\tin.cur = 0;\n";
+    code += "\t\tread_cnt = 0;\n";
+    if (linear) code += "\t\tpos_cnt = 0;\n";
+    code += "\t\tmode = 0;\n";
+    for (QString item: failedSets) {
+        code += "\t\t" + item + ".clear();\n";
+    }
+    code += "\t\tskipBlank();\n";
+    code += "\t}\n\n";
+    code += indentCode(functions);
+    return code;
+}
+
+/*!
+    @name   libraryApiCode
+    @brief  生成词法分析库的对外接口
+    @param
+    @return 代码
     @attention
 */
-void TaskOneWidget::showMiniDFA(DFA &minidfa) {
-//    qDebug() << minidfa.stateNum;
-    ui->miniDfaTableWidget->clear();
-    ui->miniDfaTableWidget->setHorizontalHeaderLabels(QStringList());
-    ui->miniDfaTableWidget->setRowCount(0);
-    ui->miniDfaTableWidget->setColumnCount(0);
-
-    ui->miniDfaTableWidget->setRowCount(minidfa.stateNum);
-    ui->miniDfaTableWidget->setColumnCount(minidfa.changeSet.size() - (minidfa.changeSet.contains("epsilon") ? 1 : 0));
-
-    QStringList strListColumnHander;
-    for (QString item : minidfa.changeSet) {
-        if (item == "epsilon") continue;
-        strListColumnHander << tr(item.toStdString().c_str());
-    }
-    ui->miniDfaTableWidget->setHorizontalHeaderLabels(strListColumnHander);
-
-    QStringList strListRowHander;
-    for (int i = 0; i < minidfa.stateNum; i++) {
-        strListRowHander << tr(QString::number(i).toStdString().c_str());
-    }
-    ui->miniDfaTableWidget->setVerticalHeaderLabels(strListRowHander);
-
-    for (int i = 0; i < minidfa.stateNum; i++) {
-        if (!minidfa.G.contains(i)) continue;
-        int j = 0;
-        for (QString stateChange: minidfa.changeSet) {
-            if (stateChange == "epsilon") continue;
-            if (minidfa.G[i].contains(stateChange)) {
-
-                int k = minidfa.G[i][stateChange];
-                QString titleTr = QString::number(k) + ":{";
-                for (int item: minidfa.mapping[k]) {
-                    titleTr += QString::number(item);
-                    titleTr += ",";
-                }
-                titleTr = titleTr.left(titleTr.size() - 1);
-                titleTr += "}";
+QString TaskOneWidget::libraryApiCode() {
+    return R"(
+lexer::lexer(): d(new impl) {
+}
 
-                ui->miniDfaTableWidget->setItem(i, j, new QTableWidgetItem(titleTr));
-            }
-            j++;
+lexer::~lexer() {
+    delete d;
+}
+
+void lexer::init(const char *data, size_t size) {
+    d->reset(data, size);
+}
+
+int lexer::next_token(lex_token &tok) {
+    return d->next_token(tok);
+}
+
+int lexer::lex_into(vector<lex_token> &tokens) {
+    lex_token tok;
+    int status;
+    while ((status = d->next_token(tok)) == ok) tokens.push_back(tok);
+    if (status == error) tokens.push_back(tok);
+    return status;
+}
+)";
+}
+
+/*!
+    @name   toBatchCode
+    @brief  生成批量分词程序
+    @param  libraryName 词法分析库的命名空间
+    @return 代码
+    @attention  由词法分析库与驱动程序拼成单个源文件：参数为源文件或目录，@文件名 表示文件列表，
+                目录递归遍历，--ext=.c,.h 只处理给定扩展名的文件，.lex 文件总是跳过；
+                每个工作线程持有一个 lexer 对象并从共享计数器领取文件，单词流写入“源文件.lex”，
+                格式与进程内批量分词相同；目录遍历使用 std::filesystem，编译时需要 -std=c++17 -pthread
+*/
+QString TaskOneWidget::toBatchCode(QString libraryName) {
+    QString header;
+    QString source = this->toCode(&header, libraryName);
+    QString code = header;
+    code += source.section('\n', 1);    // 去掉 #include 头文件
+    QString driver = R"(
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <system_error>
+#include <thread>
+
+static void write_escaped(ostream &out, const char *p, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        switch (p[i]) {
+        case '\\': out << "\\\\"; break;
+        case '\t': out << "\\t"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        default: out << p[i];
         }
     }
+}
+
+static vector<string> extensions;    // --ext= 给出的扩展名，为空时不过滤
 
-    // 添加始态、终态颜色
-    QTableWidgetItem *beginItem = ui->miniDfaTableWidget->verticalHeaderItem(minidfa.startState);
-    if (beginItem) beginItem->setTextColor(QColor(0, 255, 0));
-    for (int endState: minidfa.endStates) {
-        QTableWidgetItem *endItem = ui->miniDfaTableWidget->verticalHeaderItem(endState);
-        if (endItem) endItem->setTextColor(QColor(255, 0, 0));
+static bool wanted(const filesystem::path &path) {
+    string ext = path.extension().string();
+    if (ext == ".lex") return false;
+    return extensions.empty() || find(extensions.begin(), extensions.end(), ext) != extensions.end();
+}
+
+static void add_path(vector<string> &files, const string &name) {
+    error_code ec;
+    if (!filesystem::is_directory(name, ec)) {
+        files.push_back(name);
+        return;
+    }
+    filesystem::recursive_directory_iterator it(name, filesystem::directory_options::skip_permission_denied, ec), end;
+    for (; !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && wanted(it->path())) files.push_back(it->path().string());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 6, "--ext=") != 0) continue;
+        for (size_t from = 6; from <= arg.size();) {
+            size_t to = arg.find(',', from);
+            if (to == string::npos) to = arg.size();
+            if (to > from) extensions.push_back(arg.substr(from, to - from));
+            from = to + 1;
+        }
+    }
+
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 6, "--ext=") == 0) continue;
+        if (arg[0] != '@') {
+            add_path(files, arg);
+            continue;
+        }
+        ifstream list(arg.substr(1));
+        string line;
+        while (getline(list, line)) {
+            if (!line.empty()) add_path(files, line);
+        }
+    }
+
+    size_t workers = thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+    if (workers > files.size()) workers = files.size();
+    atomic<size_t> next(0);
+    atomic<size_t> failed(0);
+    vector<thread> pool;
+    for (size_t w = 0; w < workers; w++) {
+        pool.push_back(thread([&]() {
+            %1::lexer lexer;
+            vector<%1::lex_token> tokens;
+            string data;
+            for (size_t i = next++; i < files.size(); i = next++) {
+                ifstream in(files[i], ios::in | ios::binary);
+                if (!in) {
+                    failed++;
+                    continue;
+                }
+                data.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+                tokens.clear();
+                lexer.init(data.data(), data.size());
+                if (lexer.lex_into(tokens) == %1::lexer::error) {
+                    failed++;
+                    continue;
+                }
+                ofstream out(files[i] + ".lex", ios::out | ios::trunc | ios::binary);
+                for (const %1::lex_token &tok: tokens) {
+                    out << tok.type << '\t';
+                    write_escaped(out, tok.text, tok.length);
+                    out << '\n';
+                }
+            }
+        }));
     }
+    for (thread &worker: pool) worker.join();
+    cerr << files.size() << " files, " << failed << " failed" << endl;
+    return failed ? 1 : 0;
+}
+)";
+    code += driver.arg(libraryNamespace(libraryName));
+    return code;
+}
 
-//    ui->dfaTableWidget->resizeColumnsToContents();
-    ui->miniDfaTableWidget->resizeRowsToContents();
+/*!
+    @name   codeSpec
+    @brief  当前生成代码对应的单词定义与选项
+    @param
+    @return 分析时的单词定义与选项，加上影响生成代码的选项
+    @attention  切换这些选项时生成代码随之重新生成，因此与 codeView 中的代码一致；
+                只影响状态编号的热状态重排不参与，编号不同的程序分词结果相同
+*/
+QString TaskOneWidget::codeSpec() {
+    return tokenSpec + QString("\ntable=%1 constexpr=%2 span=%3 hashKeyword=%4 literalTrie=%5 linear=%6")
+            .arg(ui->tableCheckBox->isChecked()).arg(ui->constexprCheckBox->isChecked())
+            .arg(ui->spanCheckBox->isChecked()).arg(ui->hashKeywordCheckBox->isChecked())
+            .arg(ui->literalTrieCheckBox->isChecked()).arg(ui->linearCheckBox->isChecked());
 }
 
 /*!
     @name   toCode
     @brief  生成词法分析程序
-    @param
+    @param  header 不为空时生成词法分析库：返回源文件，头文件写入 header
+    @param  libraryName 词法分析库的文件名（不含扩展名），同时用作命名空间
     @return
-    @attention
+    @attention  词法分析库没有全局变量，分词状态都在 lexer 对象中，多个对象可以并发分词；
+                库总是直接在调用者的缓冲区上分词，单词以区间返回
 */
-QString TaskOneWidget::toCode() {
+QString TaskOneWidget::toCode(QString *header, QString libraryName) {
+    bool library = header != nullptr;
+    QString space = libraryNamespace(libraryName);
     QString code = "";
-    code += "#include <iostream>\n";
-    code += "#include <fstream>\n";
+    // 按名称排序遍历单词，生成的代码不随 QHash 的随机种子变化
+    QStringList tokenNames = id2minidfa.keys();
+    std::sort(tokenNames.begin(), tokenNames.end());
+    if (library) {
+        code += "#include \"" + libraryName + ".h\"\n";
+        code += "#include <cstdio>\n";
+        code += "#include <ios>\n";
+    } else {
+        code += "#include <iostream>\n";
+        code += "#include <fstream>\n";
+    }
     code += "#include <string>\n";
     code += "#include <cstring>\n";
     code += "#include <cctype>\n";
-    code += "#include <map>\n";
+    if (!library) code += "#include <map>\n";
+    // 关键字改用完美哈希时不生成 keyword 的 DFA，由标识符等单词匹配后查表重新分类
+    KeywordHash keywords;
+    if (ui->hashKeywordCheckBox->isChecked()) {
+        keywords.build(Lexer::hashableKeywords(id2minidfa));
+    }
+    bool hashKeyword = !keywords.empty();
+    if (hashKeyword) code += "#include <cstdint>\n";
+
+    // 线性时间：记录失败的（状态, 位置），以后的匹配到达时立即失败，不再重复扫描
+    bool linear = ui->linearCheckBox->isChecked();
+    if (linear) {
+        code += "#include <unordered_set>\n";
+    }
+
+    // 零拷贝：源程序一次读入内存，buf 系列只记录（起点, 长度），单词编码表引用源程序中的字节
+    bool span = ui->spanCheckBox->isChecked() && !library;
+    if (span) {
+        code += "#include <deque>\n";
+        code += "#include <iterator>\n";
+    }
+    bool inMemory = span || library;
+    if (linear || inMemory) code += "#include <vector>\n";
+
+    // 编译期常量表：转移表为 constexpr array，识别函数共用按表的形状特化的模板驱动
+    bool constTables = ui->tableCheckBox->isChecked() && ui->constexprCheckBox->isChecked();
+    if (constTables) code += "#include <array>\n";
+
+    // 词法模式：每个模式只尝试属于它的单词，只有一个模式时生成的代码与不分模式相同
+    QStringList modes = Lexer::modesOf(tokenNames, tokenModes);
+    auto inMode = [&](QString name, int m) {
+        return tokenModes.value(name, QStringList("INITIAL")).contains(modes[m]);
+    };
+
+    // 字面量单词合并为双数组字典树（每个模式一棵），由 check_literal 一次匹配；同一字面量归先尝试的单词
+    QStringList literalNames;
+    QVector<LiteralTrie> modeLiterals(modes.size());
+    if (ui->literalTrieCheckBox->isChecked()) {
+        QStringList order = tokenNames;
+        if (order.contains("keyword")) {
+            order.removeOne("keyword");
+            if (!hashKeyword) order.prepend("keyword");
+        }
+        QList<QStringList> literalLists;
+        for (QString dfaKey: order) {
+            QStringList literalList;
+            if (!Lexer::literalWords(id2minidfa[dfaKey], literalList)) continue;
+            literalNames.append(dfaKey);
+            literalLists.append(literalList);
+        }
+        for (int m = 0; m < modes.size(); m++) {
+            QList<QPair<QByteArray, int>> words;
+            for (int i = 0; i < literalNames.size(); i++) {
+                if (!inMode(literalNames[i], m)) continue;
+                for (QString word: literalLists[i]) {
+                    words.append(qMakePair(word.toLatin1(), i));
+                }
+            }
+            modeLiterals[m].build(words);
+        }
+    }
     code += "using namespace std;\n\n";
 
-    code += "ifstream in(\"src.txt\", ios::in);\n";         // 源代码存储的位置
-    code += "ofstream out(\"sample.lex\", ios::out | ios::trunc);\n";      // 单词编码保存的位置
-    code += "string buf, buf_err, buf_suc;\n";              // 存储单词字符串
-    code += "string token, token_suc;\n";                   // 存储单词类型
-    code += "int read_cnt;\n";                            // 当前读到文件的位置
-    code += "map<string, int> mp;\n";                       // 存储单词编码的映射
-    code += "int idx = 1;\n\n";                                   // 存储单词编码当前位置
+    if (library) {
+        code += "namespace " + space + " {\n";
+        code += libraryInputCode();
+    } else {
+        if (span) {
+            code += spanCode();
+        } else {
+            code += "ifstream in(\"src.txt\", ios::in);\n";         // 源代码存储的位置
+        }
+        code += "ofstream out(\"sample.lex\", ios::out | ios::trunc);\n";      // 单词编码保存的位置
+        if (!span) code += "string buf, buf_err, buf_suc;\n";   // 存储单词字符串
+        code += "string token, token_suc;\n";                   // 存储单词类型
+        code += "int read_cnt;\n";                            // 当前读到文件的位置
+        if (!span) code += "map<string, int> mp;\n";            // 存储单词编码的映射
+        code += "int idx = 1;\n\n";                                   // 存储单词编码当前位置
+        if (span) code += internCode();
+        if (linear) code += "long long pos_cnt;\n";           // 当前单词开始处已读入的字符数
+    }
+    if (linear) {
+        code += R"(
+bool mark_failed(unordered_set<unsigned long long> &failed, const vector<unsigned long long> &trail) {
+    for (unsigned long long key: trail) failed.insert(key);
+    return false;
+}
+
+)";
+    }
+
+    // 读写分词状态的函数放在 functions 中，词法分析库中它们是 lexer::impl 的成员
+    QString functions = "";
+    QStringList failedSets;
 
     // 跳过空白字符
-    code += "void skipBlank() {\n";
-    code += "\tchar c;\n";
-    code += "\twhile (in.get(c)) {\n";
-    code += "\t\tread_cnt++;\n";
-    code += "\t\tif (c == \'\\n\') read_cnt++;\n";
-    code += "\t\tif (!isspace(c)) {\n";
-    code += "\t\t\tread_cnt--;\n";
-    code += "\t\t\tin.unget();\n";
-    code += "\t\t\tbreak;\n";
-    code += "\t\t}\n";
-    code += "\t}\n";
-    code += "}\n";
+    functions += "void skipBlank() {\n";
+    functions += "\tchar c;\n";
+    functions += "\twhile (in.get(c)) {\n";
+    functions += "\t\tread_cnt++;\n";
+    if (linear) functions += "\t\tpos_cnt++;\n";
+    if (!inMemory) functions += "\t\tif (c == \'\\n\') read_cnt++;\n";   // 文本模式下换行占两个字节
+    functions += "\t\tif (!isspace((unsigned char)c)) {\n";
+    functions += "\t\t\tread_cnt--;\n";
+    if (linear) functions += "\t\t\tpos_cnt--;\n";
+    functions += "\t\t\tin.unget();\n";
+    functions += "\t\t\tbreak;\n";
+    functions += "\t\t}\n";
+    functions += "\t}\n";
+    functions += "}\n\n";
 
     code += R"(
 bool IsDigit(char c) {
@@ -536,17 +1861,76 @@ bool IsUpper(char c) {
 
 )";
 
-    for (auto dfaKey: id2minidfa.keys()) {
+    if (hashKeyword) {
+        int n = keywords.keys.size();
+        code += "const int KW_NUM = " + QString::number(n) + ";\n";
+        code += "const char *kw_keys[KW_NUM] = {";
+        for (int i = 0; i < n; i++) {
+            if (i % 8 == 0) code += "\n\t";
+            code += stringLiteral(keywords.keys[i]) + ", ";
+        }
+        code += "\n};\n";
+        code += "const int kw_disp[KW_NUM] = {";
+        for (int i = 0; i < n; i++) {
+            if (i % 16 == 0) code += "\n\t";
+            code += QString::number(keywords.disp[i]) + ", ";
+        }
+        code += "\n};\n";
+        code += R"(
+uint32_t kw_hash(const char *s, size_t n, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 16777619u);
+    for (size_t i = 0; i < n; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+)";
+        // 零拷贝模式下直接在源程序的字节上查询
+        code += QString(R"(bool is_keyword(const %1 &s) {
+    int d = kw_disp[kw_hash(s.data(), s.size(), 0) % KW_NUM];
+    int slot = d < 0 ? -d - 1 : kw_hash(s.data(), s.size(), d) % KW_NUM;
+    return strlen(kw_keys[slot]) == s.size() && memcmp(kw_keys[slot], s.data(), s.size()) == 0;
+}
+
+)").arg(inMemory ? "Span" : "string");
+    }
+
+    if (!literalNames.empty()) {
+        code += "const char *lit_names[] = {";
+        for (QString name: literalNames) {
+            code += stringLiteral(name.toUtf8()) + ", ";
+        }
+        code += "};\n";
+    }
+    for (int m = 0; m < modes.size(); m++) {
+        if (modeLiterals[m].empty()) continue;
+        functions += literalCode(modeLiterals[m], m == 0 ? "" : "_" + QString::number(m), code);
+    }
+
+    if (constTables) functions += dfaDriverCode();
+    for (auto dfaKey: tokenNames) {
         qDebug() << dfaKey;
+        if (hashKeyword && dfaKey == "keyword") continue;
+        if (literalNames.contains(dfaKey)) continue;
         DFA minidfa = id2minidfa[dfaKey];
+        if (linear) failedSets.append("failed_" + dfaKey);
+        if (ui->tableCheckBox->isChecked()) {
+            functions += toTableCode(dfaKey, minidfa, code);
+            continue;
+        }
         // 生成各个DFA
-        code += "bool check_" + dfaKey + "() {\n";
-        code += "\tint state = " + QString::number(minidfa.startState) + ";\n";
-        code += "\tchar c;\n";
-        code += "\twhile ((c = in.peek()) != EOF) {\n";
-        code += "\t\tswitch(state) {\n";
+        QString fail = linear ? "mark_failed(failed_" + dfaKey + ", trail)" : "false";
+        functions += "bool check_" + dfaKey + "() {\n";
+        functions += "\tint state = " + QString::number(minidfa.startState) + ";\n";
+        functions += "\tchar c;\n";
+        if (linear) functions += "\tvector<unsigned long long> trail;\n";
+        functions += "\twhile ((c = in.peek()) != EOF) {\n";
+        if (linear) functions += failedCheckCode("failed_" + dfaKey);
+        functions += "\t\tswitch(state) {\n";
         for (int i = 0; i < minidfa.stateNum; i++) {        // 遍历状态，每个状态需要一个case
-            code += "\t\tcase " + QString::number(i) + ":\n";
+            functions += "\t\tcase " + QString::number(i) + ":\n";
 
             // 调用IsDigit
             bool IsDigitFlag = true;
@@ -559,12 +1943,12 @@ bool IsUpper(char c) {
                     }
                 }
                 if (IsDigitFlag) {
-                    code += "\t\t\tif (IsDigit(c)) {\n";
-                    code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString::number(0)]) + ";\n"; // 状态转移
-                    code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                    code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                    code += "\t\t\t\tbreak;\n";
-                    code += "\t\t\t}\n";
+                    functions += "\t\t\tif (IsDigit(c)) {\n";
+                    functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString::number(0)]) + ";\n"; // 状态转移
+                    functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                    functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                    functions += "\t\t\t\tbreak;\n";
+                    functions += "\t\t\t}\n";
                 }
             }
 
@@ -579,12 +1963,12 @@ bool IsUpper(char c) {
                     }
                 }
                 if (IsPositiveDigitFlag) {
-                    code += "\t\t\tif (IsPositiveDigit(c)) {\n";
-                    code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString::number(1)]) + ";\n"; // 状态转移
-                    code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                    code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                    code += "\t\t\t\tbreak;\n";
-                    code += "\t\t\t}\n";
+                    functions += "\t\t\tif (IsPositiveDigit(c)) {\n";
+                    functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString::number(1)]) + ";\n"; // 状态转移
+                    functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                    functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                    functions += "\t\t\t\tbreak;\n";
+                    functions += "\t\t\t}\n";
                 }
             }
 
@@ -604,12 +1988,12 @@ bool IsUpper(char c) {
                     }
                 }
                 if (IsAlphaFlag) {
-                    code += "\t\t\tif (IsAlpha(c)) {\n";
-                    code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('a')]) + ";\n"; // 状态转移
-                    code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                    code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                    code += "\t\t\t\tbreak;\n";
-                    code += "\t\t\t}\n";
+                    functions += "\t\t\tif (IsAlpha(c)) {\n";
+                    functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('a')]) + ";\n"; // 状态转移
+                    functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                    functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                    functions += "\t\t\t\tbreak;\n";
+                    functions += "\t\t\t}\n";
                 }
             }
 
@@ -623,12 +2007,12 @@ bool IsUpper(char c) {
                     }
                 }
                 if (IsLowerFlag) {
-                    code += "\t\t\tif (IsLower(c)) {\n";
-                    code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('a')]) + ";\n"; // 状态转移
-                    code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                    code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                    code += "\t\t\t\tbreak;\n";
-                    code += "\t\t\t}\n";
+                    functions += "\t\t\tif (IsLower(c)) {\n";
+                    functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('a')]) + ";\n"; // 状态转移
+                    functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                    functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                    functions += "\t\t\t\tbreak;\n";
+                    functions += "\t\t\t}\n";
                 }
             }
 
@@ -642,129 +2026,230 @@ bool IsUpper(char c) {
                     }
                 }
                 if (IsUpperFlag) {
-                    code += "\t\t\tif (IsUpper(c)) {\n";
-                    code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('A')]) + ";\n"; // 状态转移
-                    code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                    code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                    code += "\t\t\t\tbreak;\n";
-                    code += "\t\t\t}\n";
+                    functions += "\t\t\tif (IsUpper(c)) {\n";
+                    functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][QString('A')]) + ";\n"; // 状态转移
+                    functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                    functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                    functions += "\t\t\t\tbreak;\n";
+                    functions += "\t\t\t}\n";
                 }
             }
 
-            code += "\t\t\tswitch (c) {\n";
-            for (QString changeItem: minidfa.G[i].keys()) {    // 遍历转移，每个转移需要一个case
+            functions += "\t\t\tswitch (c) {\n";
+            for (QString changeItem: sortedKeys(minidfa.G[i])) {    // 遍历转移，每个转移需要一个case
                 if (IsDigitFlag && changeItem[0] >= '0' && changeItem[0] <= '9') continue;
                 if (IsPositiveDigitFlag && changeItem[0] >= '1' && changeItem[0] <= '9') continue;
                 if (IsAlphaFlag && ((changeItem[0] >= 'a' && changeItem[0] <= 'z') || (changeItem[0] >= 'A' && changeItem[0] <= 'Z'))) continue;
                 if (IsLowerFlag && changeItem[0] >= 'a' && changeItem[0] <= 'z') continue;
                 if (IsUpperFlag && changeItem[0] >= 'A' && changeItem[0] <= 'Z') continue;
-                code += "\t\t\tcase \'" + changeItem + "\':\n";
-                code += "\t\t\t\tstate = " + QString::number(minidfa.G[i][changeItem]) + ";\n"; // 状态转移
-                code += "\t\t\t\tbuf += c;\n"; // buf附加字符
-                code += "\t\t\t\tin.get(c);\n"; // buf附加字符
-                code += "\t\t\t\tbreak;\n";
+                functions += "\t\t\tcase " + charLiteral(changeItem) + ":\n";
+                functions += "\t\t\t\tstate = " + QString::number(minidfa.G[i][changeItem]) + ";\n"; // 状态转移
+                functions += "\t\t\t\tbuf += c;\n"; // buf附加字符
+                functions += "\t\t\t\tin.get(c);\n"; // buf附加字符
+                functions += "\t\t\t\tbreak;\n";
             }
 
-            code += "\t\t\tdefault:\n";
+            functions += "\t\t\tdefault:\n";
             // 判断当前是否为终态
             if (minidfa.endStates.contains(i)) {
-                code += "\t\t\t\ttoken = \"" + dfaKey + "\";\n";
-                code += "\t\t\t\treturn true;\n";
+                functions += "\t\t\t\ttoken = \"" + dfaKey + "\";\n";
+                functions += "\t\t\t\treturn true;\n";
             } else {
-                code += "\t\t\t\treturn false;\n";
+                functions += "\t\t\t\treturn " + fail + ";\n";
             }
 
-            code += "\t\t\t}\n";  // switch c 结束
-            code += "\t\t\tbreak;\n"; // case state 结束
+            functions += "\t\t\t}\n";  // switch c 结束
+            functions += "\t\t\tbreak;\n"; // case state 结束
         }
-        code += "\t\t}\n";  // switch state 结束
-        code += "\t}\n";    // while 结束
+        functions += "\t\t}\n";  // switch state 结束
+        functions += "\t}\n";    // while 结束
 
         // 判断state是否为终态
-        code += "\tif (";
+        functions += "\tif (";
         int cnt = 0;
-        for (int i: minidfa.endStates) {
-            code += "state == " + QString::number(i);
+        for (int i: sortedStates(minidfa.endStates)) {
+            functions += "state == " + QString::number(i);
             cnt++;
-            if (cnt != minidfa.endStates.size()) code += "||";
+            if (cnt != minidfa.endStates.size()) functions += "||";
         }
-        code += ") {\n";
-        code += "\t\ttoken = \"" + dfaKey + "\";\n";
-        code += "\t\treturn true;\n";
-        code += "\t}\n";
+        functions += ") {\n";
+        functions += "\t\ttoken = \"" + dfaKey + "\";\n";
+        functions += "\t\treturn true;\n";
+        functions += "\t}\n";
 
-        code += "\telse return false;\n";
+        functions += "\telse return " + fail + ";\n";
 
-        code += "}\n\n";
+        functions += "}\n\n";
     }
 
-    code += "int main(void) {\n";
-    code += "\tbool flag;\n";
-    code += "\tchar c;\n";
-    code += "\tskipBlank();\n";
-    code += "\twhile ((c = in.peek()) != EOF) {\n";
-
-//    code += "cout << \"c:\" << c <<endl;";
-
-    code += "\t\ttoken_suc.clear();\n";
-    code += "\t\tbuf_suc.clear();\n";
+    // keyword 与其他单词有重叠时要在标识符之前尝试；
+    // 用集合运算（如 _identifier=word-_keyword）定义为不相交后无需区分优先级
+    bool keywordFirst = false;
+    if (id2minidfa.contains("keyword") && !hashKeyword && !literalNames.contains("keyword")) {
+        for (auto dfaKey: tokenNames) {
+            if (dfaKey == "keyword") continue;
+            DFA overlap;
+            overlap.fromProduct(id2minidfa["keyword"], id2minidfa[dfaKey], '&');
+            if (!overlap.endStates.empty()) {
+                keywordFirst = true;
+                break;
+            }
+        }
+    }
 
-    // keyword要在标识符之前
-    if (id2minidfa.contains("keyword")) {
-        code += "\t\tif (!check_keyword()) buf_err = buf;\n";
-        code += "\t\telse if (buf.size() > buf_suc.size()) {\n";
-        code += "\t\t\tbuf_suc = buf;\n";
-        code += "\t\t\ttoken_suc = token;\n";
-        code += "\t\t}\n";
+    // 依次调用识别函数，保留最长的结果
+    auto checkCode = [&](QString function, QString indent) {
+        QString block = "";
+        block += indent + "if (!" + function + "()) buf_err = buf;\n";
+        block += indent + "else if (buf.size() > buf_suc.size()) {\n";
+        block += indent + "\tbuf_suc = buf;\n";
+        block += indent + "\ttoken_suc = token;\n";
+        block += indent + "}\n";
+        block += indent + "buf.clear();\n";
+        block += indent + "in.seekg(read_cnt, ios::beg);\n";
+        return block;
+    };
+    auto modeCode = [&](int m, QString indent) {
+        QString block = "";
+        if (keywordFirst && inMode("keyword", m)) block += checkCode("check_keyword", indent);
+        if (!modeLiterals[m].empty()) block += checkCode(m == 0 ? "check_literal" : "check_literal_" + QString::number(m), indent);
+        for (auto dfaKey: tokenNames) {
+            if (!inMode(dfaKey, m)) continue;
+            if (keywordFirst && dfaKey == "keyword") continue;  // keyword 已经在前面完成
+            if (hashKeyword && dfaKey == "keyword") continue;   // keyword 由完美哈希识别
+            if (literalNames.contains(dfaKey)) continue;        // 字面量由字典树识别
+            block += checkCode("check_" + dfaKey, indent);
+        }
+        return block;
+    };
+
+    // 识别一个单词：最长匹配的结果在 buf_suc、token_suc 中，失败时 buf_suc 为空
+    QString scan = "";
+    scan += "\t\ttoken_suc.clear();\n";
+    scan += "\t\tbuf_suc.clear();\n";
+    if (modes.size() == 1) {
+        scan += modeCode(0, "\t\t");
+    } else {
+        scan += "\t\tswitch (mode) {\n";
+        for (int m = 0; m < modes.size(); m++) {
+            scan += "\t\tcase " + QString::number(m) + ":    // " + modes[m] + "\n";
+            scan += modeCode(m, "\t\t\t");
+            scan += "\t\t\tbreak;\n";
+        }
+        scan += "\t\t}\n";
+    }
 
-//        code += "cout << \"buf:\" << buf <<endl;";
-//        code += "cout << \"buf_suc:\" << buf_suc <<endl;";
+    // 成功后重新分类关键字
+    QString reclassify = "";
+    if (hashKeyword) {
+        QStringList keywordModes;
+        for (int m = 0; m < modes.size(); m++) {
+            if (inMode("keyword", m)) keywordModes << "mode == " + QString::number(m);
+        }
+        if (modes.size() == 1) reclassify += "\t\tif (is_keyword(buf_suc)) token_suc = \"keyword\";\n";
+        else reclassify += "\t\tif ((" + keywordModes.join(" || ") + ") && is_keyword(buf_suc)) token_suc = \"keyword\";\n";
+    }
 
-        code += "\t\tbuf.clear();\n";
-        code += "\t\tin.seekg(read_cnt, ios::beg);\n";
+    // 越过识别出的单词
+    QString advance = "";
+    advance += "\t\tread_cnt += buf_suc.size();\n";
+    if (linear) advance += "\t\tpos_cnt += buf_suc.size();\n";
+    advance += "\t\tin.seekg(read_cnt, ios::beg);\n";
+
+    // 模式切换，只有 INITIAL 模式跳过空白字符
+    if (modes.size() == 1) {
+        advance += "\t\tskipBlank();\n";
+    } else {
+        for (QString tokenName: tokenNames) {
+            if (!nextMode.contains(tokenName)) continue;
+            int m = modes.indexOf(nextMode[tokenName]);
+            if (m == -1) continue;
+            advance += "\t\tif (token_suc == " + stringLiteral(tokenName.toUtf8()) + ") mode = " + QString::number(m) + ";\n";
+        }
+        advance += "\t\tif (mode == 0) skipBlank();\n";
     }
 
-    for (auto dfaKey: id2minidfa.keys()) {
-        if (dfaKey == "keyword") continue;  // keyword 已经在前面完成
-        code += "\t\tif (!check_" + dfaKey + "()) buf_err = buf;\n";
-        code += "\t\telse if (buf.size() > buf_suc.size()) {\n";
-        code += "\t\t\tbuf_suc = buf;\n";
-        code += "\t\t\ttoken_suc = token;\n";
+    if (library) {
+        *header = libraryHeader(libraryName);
+        code += libraryImplCode(functions, failedSets, linear);
+
+        // 识别下一个单词，单词直接引用输入缓冲区
+        code += "\tint next_token(lex_token &tok) {\n";
+        code += "\t\tchar c;\n";
+        code += "\t\tif ((c = in.peek()) == EOF) return lexer::end;\n";
+        code += scan;
+        code += "\t\tif (buf_suc.empty()) {\n";
+        code += "\t\t\ttok.type = \"UNKNOWN\";\n";
+        code += "\t\t\ttok.text = buf_err.data();\n";
+        code += "\t\t\ttok.offset = read_cnt;\n";
+        code += "\t\t\ttok.length = buf_err.size();\n";
+        code += "\t\t\treturn lexer::error;\n";
         code += "\t\t}\n";
+        code += reclassify;
+        code += "\t\ttok.type = token_suc;\n";
+        code += "\t\ttok.text = buf_suc.data();\n";
+        code += "\t\ttok.offset = read_cnt;\n";
+        code += "\t\ttok.length = buf_suc.size();\n";
+        code += advance;
+        code += "\t\treturn lexer::ok;\n";
+        code += "\t}\n";
+        code += "};\n";
+        code += libraryApiCode();
+        code += "\n}   // namespace " + space + "\n";
+        return code;
+    }
 
-//        code += "cout << \"buf:\" << buf <<endl;";
-//        code += "cout << \"buf_suc:\" << buf_suc <<endl;";
-
-        code += "\t\tbuf.clear();\n";
-        code += "\t\tin.seekg(read_cnt, ios::beg);\n";
+    for (QString item: failedSets) {
+        code += "unordered_set<unsigned long long> " + item + ";\n";
     }
+    code += functions;
+
+    code += "int main(void) {\n";
+    code += "\tbool flag;\n";
+    code += "\tchar c;\n";
+    if (modes.size() > 1) code += "\tint mode = 0;\n";
+    code += "\tskipBlank();\n";
+    code += "\twhile ((c = in.peek()) != EOF) {\n";
+    code += scan;
 
     // 判断成功或失败
     code += "\t\tif (buf_suc.empty()) {\n";
     code += "\t\t\tout << buf_err << \" UNKNOWN\" << endl;\n";
     code += "\t\t\texit(1);\n";
     code += "\t\t}\n";
+    code += reclassify;
 
 //    code += "\t\tout << buf_suc << \" \" << token_suc << endl;\n";
-    code += "\t\tif (!isupper(token_suc[0])) {\n";
-    code += "\t\t\tif (!mp.count(token_suc)) mp[token_suc] = idx++;\n";
-    code += "\t\t\tout << mp[token_suc] << \' \' << buf_suc << \' \';\n";
-    code += "\t\t} else {\n";
-    code += "\t\t\tif (!mp.count(buf_suc)) mp[buf_suc] = idx++;\n";
-    code += "\t\t\tout << mp[buf_suc] << \' \';\n";
-    code += "\t\t}\n";
-
-    code += "\t\tread_cnt += buf_suc.size();\n";
-    code += "\t\tin.seekg(read_cnt, ios::beg);\n";
-    code += "\t\tskipBlank();\n";
-
+    if (span) {
+        code += "\t\tif (!isupper(token_suc[0])) {\n";
+        code += "\t\t\tout << intern(token_suc.data(), token_suc.size(), true) << \' \' << buf_suc << \' \';\n";
+        code += "\t\t} else {\n";
+        code += "\t\t\tout << intern(buf_suc.data(), buf_suc.size(), false) << \' \';\n";
+        code += "\t\t}\n";
+    } else {
+        code += "\t\tif (!isupper(token_suc[0])) {\n";
+        code += "\t\t\tif (!mp.count(token_suc)) mp[token_suc] = idx++;\n";
+        code += "\t\t\tout << mp[token_suc] << \' \' << buf_suc << \' \';\n";
+        code += "\t\t} else {\n";
+        code += "\t\t\tif (!mp.count(buf_suc)) mp[buf_suc] = idx++;\n";
+        code += "\t\t\tout << mp[buf_suc] << \' \';\n";
+        code += "\t\t}\n";
+    }
+    code += advance;
     code += "\t}\n";    // while 结束
 
     // 打印键值对映射
     code += "\tout << endl;\n";
-    code += "\tfor (auto item : mp) {\n";
-    code += "\t\tout << item.first << \' \' << item.second << \' \';\n";
-    code += "\t}\n";
+    if (span) {
+        code += "\tfor (const InternEntry &item : intern_table) {\n";
+        code += "\t\tif (!item.ptr) continue;\n";
+        code += "\t\tout.write(item.ptr, item.len) << \' \' << item.id << \' \';\n";
+        code += "\t}\n";
+    } else {
+        code += "\tfor (auto item : mp) {\n";
+        code += "\t\tout << item.first << \' \' << item.second << \' \';\n";
+        code += "\t}\n";
+    }
 
     code += "\tin.close();\n";
     code += "\tout.close();\n";
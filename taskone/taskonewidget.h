@@ -18,8 +18,11 @@
 #define TASKONEWIDGET_H
 
 #include <QWidget>
+#include <QStringList>
+#include <QAbstractTableModel>
 #include "nfa.h"
 #include "dfa.h"
+#include "lexer.h"
 
 namespace Ui {
 class TaskOneWidget;
@@ -37,14 +40,46 @@ public:
     QHash<QString, NFA> id2nfa;     // 正则表达式名称到NFA的映射
     QHash<QString, DFA> id2dfa;     // 正则表达式名称到DFA的映射
     QHash<QString, DFA> id2minidfa; // 正则表达式名称到最小化DFA的映射
+    QHash<QString, DFA> id2derivdfa; // 正则表达式名称到导数构造DFA的映射
+    Lexer lexer;                    // 进程内词法分析器
+    DFAImage image;                 // 载入的自动机镜像，lexer 可能引用其映射内存
+    QHash<QString, QStringList> tokenModes;     // 单词所属的词法模式，未列出的单词属于 INITIAL
+    QHash<QString, QString> nextMode;           // 识别出单词后切换到的词法模式
+    QHash<QString, QAbstractTableModel*> nfaModels;     // 正则表达式名称到 NFA 表模型的缓存
+    QHash<QString, QAbstractTableModel*> dfaModels;     // 正则表达式名称到 DFA 表模型的缓存
+    QHash<QString, QAbstractTableModel*> miniDfaModels; // 正则表达式名称到最小化 DFA 表模型的缓存
+    QString tokenSpec;              // 最近一次分析的单词定义与分析选项，用作编译缓存的键
 
 private:
     Ui::TaskOneWidget *ui;
 
-    void showNFA(NFA& nfa);          // 展示 NFA
-    void showDFA(DFA& dfa);          // 展示 DFA
-    void showMiniDFA(DFA& minidfa);  // 展示 MiniDFA
-    QString toCode();   // 生成词法分析程序
+    NFA &nfaOf(QString key);         // 获取用于展示的 NFA，必要时构造
+    void ensureMapping(QString key); // 生产模式下按需恢复 DFA 与最小化 DFA 的状态来源
+    void buildLexer();               // 按界面选项构造进程内词法分析器
+    void setLexerBusy(bool busy);    // 后台批量分词期间禁用会修改 lexer 的按钮与选项
+    QString benchmarkInterleave(QStringList fileNames);  // 比较单流分词与多流交错分词的耗时
+    void showNFA(QString key);       // 展示 NFA
+    void showDFA(QString key);       // 展示 DFA
+    void showMiniDFA(QString key);   // 展示 MiniDFA
+    void clearModels();              // 清空缓存的状态转移表模型
+    DFA buildSetDFA(QString name, QHash<QString, QString> &fullHash,
+                    QHash<QString, QStringList> &setHash, QSet<QString> visiting);    // 集合运算定义构造 DFA
+    DFA buildOperandDFA(QString name, QHash<QString, QString> &fullHash,
+                        QHash<QString, QStringList> &setHash, QSet<QString> visiting);  // 集合运算操作数构造最小化 DFA
+    QString toCode(QString *header = nullptr, QString libraryName = "scanner");    // 生成词法分析程序或词法分析库
+    QString codeSpec();                                 // 当前生成代码对应的单词定义与选项
+    QString toBatchCode(QString libraryName);           // 生成批量分词程序
+    QString toTableCode(QString dfaKey, DFA &minidfa, QString &tables);    // 生成表驱动的单词识别函数
+    QString constexprTableCode(QString dfaKey, DFA &minidfa, QString &tables);     // 生成编译期常量转移表的单词识别函数
+    QString dfaDriverCode();                            // 生成编译期常量转移表共用的模板驱动
+    QString failedCheckCode(QString failedSet);         // 生成线性时间模式下的失败组合检查
+    QString literalCode(LiteralTrie &literals, QString suffix, QString &tables);   // 生成字面量字典树及其识别函数
+    QString spanCode();                                 // 生成零拷贝模式的输入与单词区间
+    QString internCode();                               // 生成零拷贝模式的单词编码表
+    QString libraryHeader(QString libraryName);         // 生成词法分析库的头文件
+    QString libraryInputCode();                         // 生成词法分析库的输入与单词区间
+    QString libraryImplCode(QString functions, QStringList failedSets, bool linear);   // 生成词法分析库的分词状态
+    QString libraryApiCode();                           // 生成词法分析库的对外接口
 };
 
 #endif // TASKONEWIDGET_H
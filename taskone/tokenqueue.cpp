@@ -0,0 +1,102 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    tokenqueue.cpp
+*  @brief   单词流无锁队列实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "tokenqueue.h"
+
+#include <QThread>
+
+TokenQueue::TokenQueue(int capacity): head(0), tail(0), closed(0), cancelled(0) {
+    int size = 1;
+    while (size < capacity) size <<= 1;
+    ring.resize(size);
+    mask = quint32(size - 1);
+}
+
+/*!
+    @name   push
+    @brief  生产者写入一个单词
+    @param  token （单词, 类型）
+    @return 消费者已取消时返回 false
+    @attention  位置按 32 位无符号数回绕，tail - head 始终是队列中的单词数
+*/
+bool TokenQueue::push(const Token &token) {
+    quint32 t = tail.loadAcquire();
+    while (t - head.loadAcquire() > mask) {
+        if (cancelled.loadAcquire()) return false;
+        QThread::yieldCurrentThread();
+    }
+    if (cancelled.loadAcquire()) return false;
+    ring[t & mask] = token;
+    tail.storeRelease(t + 1);
+    return true;
+}
+
+/*!
+    @name   pop
+    @brief  消费者读出一个单词
+    @param  token 写入读出的（单词, 类型）
+    @return 生产者已结束且队列已空时返回 false
+    @attention  先读 closed 再检查队列，避免漏掉生产者结束前写入的最后几个单词
+*/
+bool TokenQueue::pop(Token &token) {
+    quint32 h = head.loadAcquire();
+    while (h == tail.loadAcquire()) {
+        if (closed.loadAcquire()) {
+            if (h == tail.loadAcquire()) return false;
+            break;
+        }
+        QThread::yieldCurrentThread();
+    }
+    token = ring[h & mask];
+    ring[h & mask] = Token();   // 释放单词文本
+    head.storeRelease(h + 1);
+    return true;
+}
+
+/*!
+    @name   close
+    @brief  生产者结束
+    @param  error 词法分析的错误信息，成功时为空
+    @return
+    @attention
+*/
+void TokenQueue::close(QString error) {
+    errorMessage = error;
+    closed.storeRelease(1);
+}
+
+/*!
+    @name   cancel
+    @brief  消费者取消
+    @param
+    @return
+    @attention  语法分析提前出错时调用，等待队列空位的生产者随即返回
+*/
+void TokenQueue::cancel() {
+    cancelled.storeRelease(1);
+}
+
+/*!
+    @name   error
+    @brief  生产者的错误信息
+    @param
+    @return
+    @attention  closed 的 acquire 读保证看到 close 写入的内容
+*/
+QString TokenQueue::error() const {
+    if (!closed.loadAcquire()) return QString();
+    return errorMessage;
+}
@@ -0,0 +1,52 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    tokenqueue.h
+*  @brief   单词流无锁队列头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef TOKENQUEUE_H
+#define TOKENQUEUE_H
+
+#include <QString>
+#include <QVector>
+#include <QPair>
+#include <QAtomicInteger>
+
+/*!
+    @name  TokenQueue
+    @brief 有界的单生产者单消费者无锁环形队列：词法分析线程写入（单词, 类型），语法分析线程读出。
+           head 只由消费者写，tail 只由生产者写，槽位的读写由 tail 的 release/acquire 保证先后
+*/
+class TokenQueue
+{
+public:
+    typedef QPair<QString, QString> Token;
+
+    explicit TokenQueue(int capacity = 4096);
+    bool push(const Token &token);      // 生产者写入，队列满时等待，消费者取消后返回 false
+    bool pop(Token &token);             // 消费者读出，队列空时等待，生产者结束且已读完时返回 false
+    void close(QString error = QString());  // 生产者结束，error 为词法分析的错误信息
+    void cancel();                      // 消费者不再读取，生产者随后的 push 立即返回
+    QString error() const;              // 生产者的错误信息，pop 返回 false 后有效
+
+private:
+    QVector<Token> ring;                // 环形缓冲区，大小为 2 的幂
+    quint32 mask;                       // ring.size() - 1
+    QAtomicInteger<quint32> head;       // 下一个读出的位置
+    QAtomicInteger<quint32> tail;       // 下一个写入的位置
+    QAtomicInt closed;                  // 生产者是否结束
+    QAtomicInt cancelled;               // 消费者是否取消
+    QString errorMessage;               // 在 closed 置位之前写入
+};
+
+#endif // TOKENQUEUE_H
@@ -19,16 +19,20 @@
 
 #include <QStringList>
 #include <QStack>
+#include <QVector>
+#include <QByteArray>
+#include <QPair>
 #include <QDebug>
 
 /*!
     @name   regexListPreprocessing
     @brief  正则表达式数组预处理：包含去除空格，重构[]等
     @param  regexList 正则表达式数组
+    @param  utf8 是否构造 UTF-8 字节自动机
     @return regexList 预处理后的正则表达式数组
     @attention
 */
-QStringList regexListPreprocessing(QStringList regexList) {
+QStringList regexListPreprocessing(QStringList regexList, bool utf8) {
     int lineSize = regexList.size();
 
     // 去除所有空格
@@ -36,6 +40,13 @@ QStringList regexListPreprocessing(QStringList regexList) {
         regexList[i].replace(" ", "");
     }
 
+    // UTF-8 字节自动机：非ASCII字符与[]改写为字节序列
+    if (utf8) {
+        for (int i = 0; i < lineSize; i++) {
+            regexList[i] = utf8Regex(regexList[i]);
+        }
+    }
+
     // 替换[]
     for (int i = 0; i < lineSize; i++) {
         int leftBracket = -1;    // 左右括号位置
@@ -77,6 +88,129 @@ QStringList regexListPreprocessing(QStringList regexList) {
     return regexList;
 }
 
+/*!
+    @name   utf8Split
+    @brief  将码点区间拆分为若干段，每段的 UTF-8 编码长度相同且每个字节各自构成连续区间
+    @param  lo 区间下界
+    @param  hi 区间上界
+    @param  seqs 拆分结果：每段的最小编码与最大编码
+    @return
+    @attention
+*/
+static void utf8Split(uint lo, uint hi, QList<QPair<QByteArray, QByteArray>> &seqs) {
+    if (lo > hi) return;
+
+    // 跳过代理区
+    if (lo <= 0xDFFF && hi >= 0xD800) {
+        if (lo < 0xD800) utf8Split(lo, 0xD7FF, seqs);
+        if (hi > 0xDFFF) utf8Split(0xE000, hi, seqs);
+        return;
+    }
+
+    // 按编码长度拆分
+    static const uint maxCode[] = {0x7F, 0x7FF, 0xFFFF};
+    for (uint m: maxCode) {
+        if (lo <= m && hi > m) {
+            utf8Split(lo, m, seqs);
+            utf8Split(m + 1, hi, seqs);
+            return;
+        }
+    }
+
+    // 按续字节边界拆分，使每个字节位置都是连续区间
+    for (int i = 1; i < 4; i++) {
+        uint m = (1u << (6 * i)) - 1;
+        if ((lo & ~m) != (hi & ~m)) {
+            if ((lo & m) != 0) {
+                utf8Split(lo, lo | m, seqs);
+                utf8Split((lo | m) + 1, hi, seqs);
+                return;
+            }
+            if ((hi & m) != m) {
+                utf8Split(lo, (hi & ~m) - 1, seqs);
+                utf8Split(hi & ~m, hi, seqs);
+                return;
+            }
+        }
+    }
+
+    seqs.append(qMakePair(QString::fromUcs4(&lo, 1).toUtf8(), QString::fromUcs4(&hi, 1).toUtf8()));
+}
+
+/*!
+    @name   utf8RangeRegex
+    @brief  将码点区间 [lo, hi] 编译为 UTF-8 字节序列的正则表达式
+    @param  lo 区间下界
+    @param  hi 区间上界
+    @return 字节序列的或，相邻字节区间已合并
+    @attention  跳过代理区 U+D800~U+DFFF
+*/
+QString utf8RangeRegex(uint lo, uint hi) {
+    QList<QPair<QByteArray, QByteArray>> seqs;
+    utf8Split(lo, hi, seqs);
+
+    QStringList seqRegexList;
+    for (QPair<QByteArray, QByteArray> seq: seqs) {
+        QString seqRegex = "";
+        for (int i = 0; i < seq.first.size(); i++) {
+            uchar beginByte = seq.first[i], endByte = seq.second[i];
+            if (beginByte == endByte) {
+                seqRegex += QChar(beginByte);
+                continue;
+            }
+            QString byteRegex = "";
+            for (uint b = beginByte; b <= endByte; b++) {
+                byteRegex += QChar(uchar(b));
+                byteRegex += '|';
+            }
+            seqRegex += "(" + byteRegex.left(byteRegex.size() - 1) + ")";
+        }
+        seqRegexList.append(seqRegex);
+    }
+    return "(" + seqRegexList.join("|") + ")";
+}
+
+/*!
+    @name   utf8Regex
+    @brief  将正则表达式中的非ASCII字符与[]字符类改写为 UTF-8 字节序列
+    @param  regex 正则表达式
+    @return 以字节（编码 0~255 的字符）为转移的正则表达式
+    @attention  []内按“下界-上界”三个字符一组解析，与 regexListPreprocessing 一致
+*/
+QString utf8Regex(QString regex) {
+    QVector<uint> codes = regex.toUcs4();
+    QString result = "";
+    for (int i = 0; i < codes.size(); i++) {
+        if (codes[i] == '\\' && i + 1 < codes.size()) {     // 转义字符
+            i++;
+            if (codes[i] < 0x80) result += "\\" + QString(QChar(codes[i]));
+            else result += utf8RangeRegex(codes[i], codes[i]);
+        } else if (codes[i] == '[') {
+            int j = i + 1;
+            while (j < codes.size() && codes[j] != ']') j++;
+            if (j >= codes.size() || j == i + 1) {           // 没有匹配的右括号，按普通字符处理
+                result += QChar(codes[i]);
+                continue;
+            }
+            QStringList rangeRegexList;
+            for (int k = i + 1; k + 2 < j; k += 3) {
+                rangeRegexList.append(utf8RangeRegex(codes[k], codes[k + 2]));
+            }
+            if (rangeRegexList.empty()) {               // 不足一组时保持原样
+                result += QChar(codes[i]);
+                continue;
+            }
+            result += "(" + rangeRegexList.join("|") + ")";
+            i = j;
+        } else if (codes[i] >= 0x80) {
+            result += utf8RangeRegex(codes[i], codes[i]);
+        } else {
+            result += QChar(codes[i]);
+        }
+    }
+    return result;
+}
+
 /*!
     @name   buildReHash
     @brief  正则表达式数组转换为hash表：key为正则表达式等号左侧，value为右侧
@@ -105,13 +239,79 @@ QHash<QString, QString> buildReHash(QStringList regexList) {
 }
 
 /*!
-    @name   combineRegex
-    @brief  合并正则表达式，仅保留需要展示的
+    @name   buildModeHash
+    @brief  解析单词名称上的词法模式标注
+    @param  reHash 正则表达式哈希，标注从键中去除
+    @param  tokenModes 单词所属的模式
+    @param  nextMode 单词识别后切换到的模式
+    @return
+    @attention  等号左侧以 <模式列表> 开头表示所属模式，以 >模式 结尾表示切换目标
+*/
+void buildModeHash(QHash<QString, QString> &reHash, QHash<QString, QStringList> &tokenModes, QHash<QString, QString> &nextMode) {
+    for (QString key: reHash.keys()) {
+        QString name = key;
+        QStringList modes;
+        QString next;
+        if (name.startsWith('<') && name.indexOf('>') != -1) {
+            int right = name.indexOf('>');
+            modes = name.mid(1, right - 1).split(',', QString::SkipEmptyParts);
+            name = name.mid(right + 1);
+        }
+        if (name.indexOf('>') != -1) {
+            next = name.mid(name.indexOf('>') + 1);
+            name = name.left(name.indexOf('>'));
+        }
+        if (name == key || name.isEmpty()) continue;
+
+        reHash[name] = reHash.take(key);
+        QString tokenName = name[0] == '_' ? name.right(name.size() - 1) : name;
+        if (!modes.empty()) tokenModes[tokenName] = modes;
+        if (!next.isEmpty()) nextMode[tokenName] = next;
+    }
+}
+
+/*!
+    @name   buildSetHash
+    @brief  找出集合运算定义：等号右侧为以 - （差）或 & （交）连接的已定义名称，如 _identifier=word-_keyword
+    @param  reHash 正则表达式哈希
+    @return 集合运算哈希：key为名称，value为操作数与运算符交替的列表
+    @attention  只有所有操作数都是已定义的名称时才视为集合运算，否则 - 与 & 仍按普通字符处理
+*/
+QHash<QString, QStringList> buildSetHash(QHash<QString, QString> reHash) {
+    QHash<QString, QStringList> setHash;
+    for (QString key: reHash.keys()) {
+        QString body = reHash[key];
+        QStringList setList;
+        QString operand = "";
+        bool isSet = true;
+        for (int i = 0; i <= body.size(); i++) {
+            if (i == body.size() || body[i] == '-' || body[i] == '&') {
+                if (operand == key || !reHash.contains(operand)) {     // 操作数必须是其他已定义名称
+                    isSet = false;
+                    break;
+                }
+                setList.append(operand);
+                if (i < body.size()) setList.append(QString(body[i]));
+                operand = "";
+            } else {
+                operand += body[i];
+            }
+        }
+        if (isSet && setList.size() >= 3) {
+            setHash.insert(key, setList);
+        }
+    }
+    return setHash;
+}
+
+/*!
+    @name   expandRegex
+    @brief  展开正则表达式中引用的其他名称，保留全部名称
     @param  reHash 原本的正则表达式哈希
-    @return 合并后的正则表达式哈希
+    @return 展开后的正则表达式哈希
     @attention
 */
-QHash<QString, QString> combineRegex(QHash<QString, QString> reHash) {
+QHash<QString, QString> expandRegex(QHash<QString, QString> reHash) {
     for (QString key: reHash.keys()) {      // 逐个正则表达式进行替换
         QString replaceString = reHash[key];
         if (replaceString[0] != '(' || replaceString[replaceString.size() - 1] != ')') {
@@ -123,6 +323,18 @@ QHash<QString, QString> combineRegex(QHash<QString, QString> reHash) {
 //            qDebug() << reHash[newkey];
         }
     }
+    return reHash;
+}
+
+/*!
+    @name   combineRegex
+    @brief  合并正则表达式，仅保留需要展示的
+    @param  reHash 原本的正则表达式哈希
+    @return 合并后的正则表达式哈希
+    @attention
+*/
+QHash<QString, QString> combineRegex(QHash<QString, QString> reHash) {
+    reHash = expandRegex(reHash);
     QHash<QString, QString> newReHash;  // 生成新的哈希
     for (QString key: reHash.keys()) {
         if (key[0] == '_') {
@@ -223,6 +435,55 @@ QString regexToPostFix(QString re) {
     return postFixRegex;
 }
 
+/*!
+    @name   regexLiterals
+    @brief  后缀正则表达式为纯字面量时，求出它表示的全部字符串
+    @param  re 后缀正则表达式
+    @param  limit 字符串数量上限
+    @return 字符串列表，含闭包或超过上限时为空
+    @attention  与 NFA::fromRegex 一样按后缀表达式求值，只是栈中存放字符串集合
+*/
+QStringList regexLiterals(QString re, int limit) {
+    QStack<QStringList> stk;
+    for (int i = 0; i < re.size(); i++) {
+        QChar c = re[i];
+        if (c == '\\') {
+            i++;
+            if (i < re.size()) stk.push(QStringList(QString(re[i])));
+        } else if (c == '|' || c == '.') {
+            if (stk.size() < 2) return QStringList();
+            QStringList right = stk.pop();
+            QStringList left = stk.pop();
+            QStringList result;
+            if (c == '|') {
+                result = left + right;
+                result.removeDuplicates();
+            } else {
+                if ((qint64)left.size() * right.size() > limit) return QStringList();
+                for (QString l: left) {
+                    for (QString r: right) {
+                        result.append(l + r);
+                    }
+                }
+                result.removeDuplicates();
+            }
+            if (result.size() > limit) return QStringList();
+            stk.push(result);
+        } else if (c == '?') {
+            if (stk.empty()) return QStringList();
+            if (!stk.top().contains("")) stk.top().append("");
+        } else if (c == '*' || c == '+') {
+            return QStringList();           // 闭包不是有限集合
+        } else if (c == '#') {
+            stk.push(QStringList(""));
+        } else {
+            stk.push(QStringList(QString(c)));
+        }
+    }
+    if (stk.size() != 1) return QStringList();
+    return stk.top();
+}
+
 /*!
     @name   getPriority
     @brief  获取运算符优先级
@@ -24,10 +24,30 @@
     @name   regexListPreprocessing
     @brief  正则表达式数组预处理：包含去除空格，重构[]等
     @param  正则表达式数组
+    @param  utf8 是否构造 UTF-8 字节自动机
     @return 预处理后的正则表达式数组
     @attention
 */
-QStringList regexListPreprocessing(QStringList regexList);
+QStringList regexListPreprocessing(QStringList regexList, bool utf8 = false);
+
+/*!
+    @name   utf8Regex
+    @brief  将正则表达式中的非ASCII字符与[]字符类改写为 UTF-8 字节序列
+    @param  regex 正则表达式
+    @return 以字节（编码 0~255 的字符）为转移的正则表达式
+    @attention
+*/
+QString utf8Regex(QString regex);
+
+/*!
+    @name   utf8RangeRegex
+    @brief  将码点区间 [lo, hi] 编译为 UTF-8 字节序列的正则表达式
+    @param  lo 区间下界
+    @param  hi 区间上界
+    @return 字节序列的或，相邻字节区间已合并
+    @attention  跳过代理区 U+D800~U+DFFF
+*/
+QString utf8RangeRegex(uint lo, uint hi);
 
 /*!
     @name   buildReHash
@@ -38,6 +58,35 @@ QStringList regexListPreprocessing(QStringList regexList);
 */
 QHash<QString, QString> buildReHash(QStringList regexList);
 
+/*!
+    @name   buildModeHash
+    @brief  解析单词名称上的词法模式标注，如 <COMMENT>_commentEnd>INITIAL 表示单词属于 COMMENT 模式、识别后切换到 INITIAL
+    @param  reHash 正则表达式哈希，标注从键中去除
+    @param  tokenModes 单词（去掉下划线）所属的模式，<A,B> 表示属于多个模式
+    @param  nextMode 单词（去掉下划线）识别后切换到的模式
+    @return
+    @attention  没有标注的单词属于 INITIAL 且不切换模式
+*/
+void buildModeHash(QHash<QString, QString> &reHash, QHash<QString, QStringList> &tokenModes, QHash<QString, QString> &nextMode);
+
+/*!
+    @name   buildSetHash
+    @brief  找出集合运算定义：等号右侧为以 - （差）或 & （交）连接的已定义名称，如 _identifier=word-_keyword
+    @param  reHash 正则表达式哈希
+    @return 集合运算哈希：key为名称，value为操作数与运算符交替的列表
+    @attention  只有所有操作数都是已定义的名称时才视为集合运算，否则 - 与 & 仍按普通字符处理
+*/
+QHash<QString, QStringList> buildSetHash(QHash<QString, QString> reHash);
+
+/*!
+    @name   expandRegex
+    @brief  展开正则表达式中引用的其他名称，保留全部名称
+    @param  reHash 原本的正则表达式哈希
+    @return 展开后的正则表达式哈希
+    @attention
+*/
+QHash<QString, QString> expandRegex(QHash<QString, QString> reHash);
+
 /*!
     @name   combineRegex
     @brief  合并正则表达式，仅保留需要展示的
@@ -65,6 +114,16 @@ QString addConnectOp(QString re);
 */
 QString regexToPostFix(QString re);
 
+/*!
+    @name   regexLiterals
+    @brief  后缀正则表达式为纯字面量（只有字符、连接、或、可选）时，求出它表示的全部字符串
+    @param  re 后缀正则表达式
+    @param  limit 字符串数量上限
+    @return 字符串列表，含闭包或超过上限时为空
+    @attention
+*/
+QStringList regexLiterals(QString re, int limit);
+
 /*!
     @name   getPriority
     @brief  获取运算符优先级
@@ -27,11 +27,14 @@
 #include <QQueue>
 #include <QStack>
 #include <QDateTime>
+#include <QtConcurrent>
 
 #include "intermediatecode.h"
+#include "tokenstream.h"
+#include "../taskone/lexer.h"
 
 TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
-    QWidget(parent), canAnalysis(false),
+    QWidget(parent), canAnalysis(false), lexer(nullptr),
     ui(new Ui::TaskTwoWidget)
 {
     ui->setupUi(this);
@@ -444,13 +447,8 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
         ui->analysisLexTableWidget->resizeRowsToContents();
     });
 
-    // 单词编码分析
-    connect(ui->grammarButton, &QPushButton::clicked, this, [&]() {
-        if (!canAnalysis) {
-            QMessageBox::warning(this, "警告", "还未进行文法分析！");
-            return;
-        }
-
+    // 语法分析：sentence 为输入单词流，来自单词编码表或同时运行的词法分析线程
+    auto analyse = [this](TokenStream &sentence) {
         if (syntaxAction.empty()) {
             QMessageBox::warning(this, "警告", "还未上传生成语法树的语义动作！");
         } else if (interAction.empty()) {
@@ -466,18 +464,12 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
 
         ui->sentenceWidget->setHorizontalHeaderLabels(QStringList() << "分析栈" << "单词编码输入");
 
-        QQueue<QPair<QString, QString>> sentence;   // 输入队列(first表示token，second表示token类型)
         QStack<StkItem> analysisStack;                // 分析栈
 
-        for (int i = 0; i < ui->analysisLexTableWidget->rowCount(); i++) {
-            QTableWidgetItem* item1 = ui->analysisLexTableWidget->item(i, 0);
-            QTableWidgetItem* item2 = ui->analysisLexTableWidget->item(i, 1);
-            if (item2->text() == "annotation") continue;
-            if (item1 && item2) {
-                sentence.push_back({item1->text(), item2->text()});
-            }
-        }
-        sentence.push_back({"$", "end"});
+        // 词法分析出错时语法分析停在出错的单词上，报告词法错误
+        auto mismatch = [&]() {
+            return sentence.error().isEmpty() ? QString("待分析的句子与文法不匹配") : "词法分析出错：" + sentence.error();
+        };
 
         StkItem firstItem, secondItem;
         firstItem.kind = 0;
@@ -513,6 +505,7 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
                 str += pair.first;
                 str += " ";
             }
+            if (!sentence.finished()) str += "...";     // 流式输入只缓存向前看的单词
             ui->sentenceWidget->setItem(cnt, 1, new QTableWidgetItem(str));
             cnt++;
         };
@@ -532,7 +525,7 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
         while (true) {
             StkItem stkItem = analysisStack.top();
             if (stkItem.kind == 0) {    // 栈顶取出的必须是状态，而不能是符号
-                QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                 return;
             }
 
@@ -598,14 +591,14 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
                     popCnt--;
                 }
                 if (popCnt || analysisStack.empty()) {
-                    QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                    QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                     return;
                 }
 
                 // 添加规约左侧元素
                 StkItem nextStkItem = analysisStack.top();
                 if (nextStkItem.kind != 1) {
-                    QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                    QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                     return;
                 }
 
@@ -949,18 +942,18 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
                 printAnalysis();
 
             } else if (analysisTableItem.kind == 3) {   // 非终结符移进
-                QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                 return;
             } else if (analysisTableItem.kind == 4) {   // 接受态
                 if (sentence.front().first == "$") {
                     QMessageBox::information(this, "提醒", "分析完毕，该单词编码文件属于该文法的句子", QMessageBox::Yes);
                     break;
                 } else {
-                    QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                    QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                     return;
                 }
             } else {
-                QMessageBox::warning(this, "警告", "待分析的句子与文法不匹配", QMessageBox::Yes);
+                QMessageBox::warning(this, "警告", mismatch(), QMessageBox::Yes);
                 return;
             }
         }
@@ -1001,6 +994,59 @@ TaskTwoWidget::TaskTwoWidget(QWidget *parent) :
             ui->interCodeBrowser->setText(code);
         }
 
+    };
+
+    // 单词编码分析
+    connect(ui->grammarButton, &QPushButton::clicked, this, [this, analyse]() {
+        if (!canAnalysis) {
+            QMessageBox::warning(this, "警告", "还未进行文法分析！");
+            return;
+        }
+
+        TokenStream sentence;   // 输入队列(first表示token，second表示token类型)
+        for (int i = 0; i < ui->analysisLexTableWidget->rowCount(); i++) {
+            QTableWidgetItem* item1 = ui->analysisLexTableWidget->item(i, 0);
+            QTableWidgetItem* item2 = ui->analysisLexTableWidget->item(i, 1);
+            if (item2->text() == "annotation") continue;
+            if (item1 && item2) {
+                sentence.push_back({item1->text(), item2->text()});
+            }
+        }
+        sentence.push_back({"$", "end"});
+        analyse(sentence);
+    });
+
+    // 源程序流式语法分析：词法分析线程把单词写入有界队列，语法分析同时从队列读取，不经过文件与单词编码表
+    connect(ui->streamButton, &QPushButton::clicked, this, [this, analyse]() {
+        if (!canAnalysis) {
+            QMessageBox::warning(this, "警告", "还未进行文法分析！");
+            return;
+        }
+        if (!lexer || lexer->names.empty()) {
+            QMessageBox::warning(this, "警告", "还未在项目任务一中构造词法分析器！");
+            return;
+        }
+
+        QString fileName = QFileDialog::getOpenFileName(this, "选择源程序文件");
+        if (fileName.isEmpty()) return;
+        QString src;
+        if (!Lexer::readSource(fileName, src)) {
+            QMessageBox::warning(this, "警告", "文件打开失败！");
+            return;
+        }
+
+        // 工作线程使用词法分析器的副本，分析过程中弹出提示时项目任务一重新构造也不受影响；
+        // 由镜像载入的转移表引用映射内存，拷贝只是浅复制，须复制一份，否则重新载入镜像会解除映射
+        TokenQueue queue;
+        Lexer worker = *lexer;
+        for (DFATable &table: worker.tables) table.detach();
+        QFuture<void> future = QtConcurrent::run([worker, src, &queue]() {
+            worker.stream(src, &queue);
+        });
+        TokenStream sentence(&queue);
+        analyse(sentence);
+        queue.cancel();     // 语法分析提前结束时让词法分析线程退出
+        future.waitForFinished();
     });
 
     // 保存中间代码
@@ -28,6 +28,8 @@
 #include <QSet>
 #include <QStringList>
 
+class Lexer;
+
 namespace Ui {
 class TaskTwoWidget;
 }
@@ -62,6 +64,9 @@ public:
 
     // 判断是否已经构建LALR1
     bool canAnalysis;
+
+    // 项目任务一的进程内词法分析器，用于源程序流式语法分析
+    const Lexer *lexer;
 private:
     Ui::TaskTwoWidget *ui;
 };
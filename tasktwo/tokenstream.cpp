@@ -0,0 +1,69 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    tokenstream.cpp
+*  @brief   语法分析输入单词流实现
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#include "tokenstream.h"
+
+TokenStream::TokenStream(TokenQueue *queue): queue(queue), done(queue == nullptr) {
+}
+
+void TokenStream::push_back(const Token &token) {
+    buffer.push_back(token);
+}
+
+void TokenStream::push_front(const Token &token) {
+    buffer.push_front(token);
+}
+
+void TokenStream::pop_front() {
+    buffer.pop_front();
+}
+
+/*!
+    @name   front
+    @brief  当前单词
+    @param
+    @return （单词, 类型）
+    @attention  缓存为空时阻塞读取队列，跳过注释；队列读完后补上结束符 $，
+                词法分析出错时补上一个不属于任何文法的空单词，使语法分析在出错处停止
+*/
+const TokenStream::Token &TokenStream::front() {
+    while (buffer.empty() && !done) {
+        Token token;
+        if (queue->pop(token)) {
+            if (token.second != "annotation") buffer.push_back(token);
+            continue;
+        }
+        done = true;
+        lexError = queue->error();
+        buffer.push_back(lexError.isEmpty() ? Token("$", "end") : Token("", ""));
+    }
+    return buffer.front();
+}
+
+/*!
+    @name   finished
+    @brief  输入是否已全部读入缓存
+    @param
+    @return
+    @attention  为 false 时 begin() 到 end() 只是剩余输入的开头
+*/
+bool TokenStream::finished() const {
+    return done;
+}
+
+QString TokenStream::error() const {
+    return lexError;
+}
@@ -0,0 +1,54 @@
+/**
+*****************************************************************************
+*  Copyright (C), 2024, 林泽勋 20212821020
+*  All right reserved. See COPYRIGHT for detailed Information.
+*
+*  @file    tokenstream.h
+*  @brief   语法分析输入单词流头文件
+*
+*  @author  林泽勋
+*  @date    2024-11-05
+*  @version V1.0.0
+*----------------------------------------------------------------------------
+*  @note 历史版本  修改人员    修改内容
+*  @note V1.0.0   林泽勋     创建文件
+*****************************************************************************
+*/
+#ifndef TOKENSTREAM_H
+#define TOKENSTREAM_H
+
+#include <QString>
+#include <QQueue>
+#include <QPair>
+
+#include "../taskone/tokenqueue.h"
+
+/*!
+    @name  TokenStream
+    @brief 语法分析的输入：接口与原先的 QQueue 输入队列一致；
+           不接队列时单词全部由 push_back 给出，接队列时只缓存向前看的单词，其余按需从队列读取
+*/
+class TokenStream
+{
+public:
+    typedef QPair<QString, QString> Token;
+
+    explicit TokenStream(TokenQueue *queue = nullptr);
+    void push_back(const Token &token);     // 追加单词
+    void push_front(const Token &token);    // 在最前面插入单词（如空串 @）
+    void pop_front();                       // 移除当前单词
+    const Token &front();                   // 当前单词，缓存为空时从队列读取
+    bool finished() const;                  // 输入是否已全部读入缓存
+    QString error() const;                  // 读到的词法分析错误信息
+
+    QQueue<Token>::const_iterator begin() const { return buffer.constBegin(); }
+    QQueue<Token>::const_iterator end() const { return buffer.constEnd(); }
+
+private:
+    QQueue<Token> buffer;       // 已读入、尚未消耗的单词
+    TokenQueue *queue;          // 单词来源，为空时只使用 buffer
+    bool done;                  // 队列是否已读完
+    QString lexError;           // 词法分析的错误信息
+};
+
+#endif // TOKENSTREAM_H